@@ -1,12 +1,157 @@
 #include <Arduino.h>
 
 /*
- *  This sketch demonstrates how to scan WiFi networks.
- *  The API is almost the same as with the WiFi Shield library,
- *  the most obvious difference being the different file you need to include:
+ *  Site-survey scanner.
+ *
+ *  The original sketch called the blocking WiFi.scanNetworks(), which
+ *  froze loop() for several seconds per sweep and then printed every
+ *  result with a delay per row. This version runs one channel at a
+ *  time asynchronously: loop() stays free, each channel completion
+ *  merges its results and immediately kicks off the next channel from
+ *  the mask, and only the channels we actually deploy on are dwelled
+ *  on. Results are kept as a fixed top-N table keyed on RSSI with one
+ *  entry per SSID (strongest BSS wins), printed once per full sweep.
  */
 #include "WiFi.h"
 
+// Bit n = scan channel n. Default: the non-overlapping 2.4GHz set.
+#define CHANNEL_MASK   ((1UL << 1) | (1UL << 6) | (1UL << 11))
+#define DWELL_MS       120   // active dwell per channel
+#define TOP_N          10
+
+struct ScanEntry {
+    char ssid[33];
+    int32_t rssi;
+    uint8_t channel;
+    wifi_auth_mode_t auth;
+};
+
+// Top-N table ordered as a min-heap on RSSI: the root is the weakest
+// kept network, so a new result either beats it and replaces it or is
+// dropped in O(1)/O(log N) — no unbounded list, no sort per sweep.
+static ScanEntry top_tab[TOP_N];
+static int top_count = 0;
+
+static uint8_t current_channel = 0;
+static bool scan_running = false;
+static uint32_t sweep_count = 0;
+static uint32_t sweep_start_ms = 0;
+
+static void heapSwap(int a, int b)
+{
+    ScanEntry t = top_tab[a];
+    top_tab[a] = top_tab[b];
+    top_tab[b] = t;
+}
+
+static void heapSiftDown(int i)
+{
+    for (;;) {
+        int small = i;
+        int l = 2 * i + 1, r = 2 * i + 2;
+        if (l < top_count && top_tab[l].rssi < top_tab[small].rssi) small = l;
+        if (r < top_count && top_tab[r].rssi < top_tab[small].rssi) small = r;
+        if (small == i) return;
+        heapSwap(i, small);
+        i = small;
+    }
+}
+
+static void heapSiftUp(int i)
+{
+    while (i > 0 && top_tab[i].rssi < top_tab[(i - 1) / 2].rssi) {
+        heapSwap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void topInsert(const char *ssid, int32_t rssi, uint8_t channel, wifi_auth_mode_t auth)
+{
+    // SSID dedupe: keep only the strongest BSS of a network
+    for (int i = 0; i < top_count; i++) {
+        if (strncmp(top_tab[i].ssid, ssid, sizeof(top_tab[i].ssid)) == 0) {
+            if (rssi > top_tab[i].rssi) {
+                top_tab[i].rssi = rssi;
+                top_tab[i].channel = channel;
+                top_tab[i].auth = auth;
+                heapSiftDown(i);
+            }
+            return;
+        }
+    }
+
+    if (top_count < TOP_N) {
+        ScanEntry &e = top_tab[top_count];
+        strncpy(e.ssid, ssid, sizeof(e.ssid) - 1);
+        e.ssid[sizeof(e.ssid) - 1] = '\0';
+        e.rssi = rssi;
+        e.channel = channel;
+        e.auth = auth;
+        top_count++;
+        heapSiftUp(top_count - 1);
+    } else if (rssi > top_tab[0].rssi) {
+        // beats the weakest kept network: replace the heap root
+        ScanEntry &e = top_tab[0];
+        strncpy(e.ssid, ssid, sizeof(e.ssid) - 1);
+        e.ssid[sizeof(e.ssid) - 1] = '\0';
+        e.rssi = rssi;
+        e.channel = channel;
+        e.auth = auth;
+        heapSiftDown(0);
+    }
+}
+
+static uint8_t nextMaskedChannel(uint8_t after)
+{
+    for (uint8_t ch = after + 1; ch <= 14; ch++) {
+        if (CHANNEL_MASK & (1UL << ch)) {
+            return ch;
+        }
+    }
+    return 0;  // sweep complete
+}
+
+static void startChannelScan(uint8_t channel)
+{
+    // async, no hidden SSIDs, active scan, bounded dwell, one channel
+    WiFi.scanNetworks(true, false, false, DWELL_MS, channel);
+    current_channel = channel;
+    scan_running = true;
+}
+
+static void printSweep()
+{
+    // Drain the heap weakest-first into a scratch list so the report
+    // comes out strongest-first.
+    ScanEntry ordered[TOP_N];
+    int n = top_count;
+    while (top_count > 0) {
+        ordered[top_count - 1] = top_tab[0];
+        top_tab[0] = top_tab[--top_count];
+        heapSiftDown(0);
+    }
+
+    Serial.print("sweep ");
+    Serial.print(sweep_count);
+    Serial.print(": ");
+    Serial.print(n);
+    Serial.print(" networks, ");
+    Serial.print(millis() - sweep_start_ms);
+    Serial.println(" ms");
+    for (int i = 0; i < n; i++) {
+        Serial.print(i + 1);
+        Serial.print(", ");
+        Serial.print(ordered[i].ssid);
+        Serial.print(",");
+        Serial.print(ordered[i].rssi);
+        Serial.print(",ch");
+        Serial.print(ordered[i].channel);
+        Serial.print(",");
+        Serial.println((ordered[i].auth == WIFI_AUTH_OPEN) ? " " : " Secured");
+    }
+    Serial.println("");
+}
+
 void setup()
 {
     Serial.begin(115200);
@@ -17,36 +162,33 @@ void setup()
     delay(100);
 
     Serial.println("Setup done");
+    sweep_start_ms = millis();
+    startChannelScan(nextMaskedChannel(0));
 }
 
 void loop()
 {
-    Serial.println("scan start");
-
-    // WiFi.scanNetworks will return the number of networks found
-    int n = WiFi.scanNetworks();
-    Serial.println("scan done");
-    if (n == 0) {
-        Serial.println("no networks found");
-    } else {
-        Serial.print(n);
-        Serial.println(" networks found");
-        for (int i = 0; i < n; ++i) {
-            // Print SSID and RSSI for each network found
-            Serial.print(i + 1);
-            Serial.print(", ");
-            Serial.print(WiFi.SSID(i));
-            Serial.print(",");
-            Serial.print(WiFi.RSSI(i));
-            Serial.print(",");
-            Serial.print(WiFi.encryptionType(i));
-            Serial.print(",");
-            Serial.println((WiFi.encryptionType(i) == WIFI_AUTH_OPEN)?" ":" Secured");
-            delay(10);
+    if (scan_running) {
+        int n = WiFi.scanComplete();
+        if (n >= 0) {
+            // this channel is done; merge and move straight on
+            for (int i = 0; i < n; i++) {
+                topInsert(WiFi.SSID(i).c_str(), WiFi.RSSI(i),
+                          WiFi.channel(i), WiFi.encryptionType(i));
+            }
+            WiFi.scanDelete();
+            scan_running = false;
+
+            uint8_t next = nextMaskedChannel(current_channel);
+            if (next == 0) {
+                sweep_count++;
+                printSweep();
+                sweep_start_ms = millis();
+                next = nextMaskedChannel(0);
+            }
+            startChannelScan(next);
         }
     }
-    Serial.println("");
 
-    // Wait a bit before scanning again
-    delay(5000);
-}
\ No newline at end of file
+    // loop() is free between completions: sensing, comms, whatever.
+}
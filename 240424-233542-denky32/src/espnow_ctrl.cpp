@@ -0,0 +1,59 @@
+/* ESP-NOW control channel implementation.
+
+   The receive callback runs in the WiFi task; it only validates the
+   frame and copies it into a shared buffer with a sequence counter, so
+   the hot path never blocks. loop() picks the command up on its next
+   pass via espnow_ctrl_poll().
+*/
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+
+#include "espnow_ctrl.h"
+
+static volatile uint32_t cmd_seq = 0;
+static uint32_t cmd_seen = 0;
+static struct spider_cmd cmd_buf;
+
+static void onEspNowRecv(const uint8_t *mac, const uint8_t *data, int len)
+{
+  if (len != sizeof(struct spider_cmd)) {
+    return;
+  }
+  const struct spider_cmd *cmd = (const struct spider_cmd *)data;
+  if (cmd->magic != SPIDER_CMD_MAGIC) {
+    return;
+  }
+  /* Latest-wins: a torn read is prevented by re-checking the sequence
+     counter on the consumer side. */
+  memcpy(&cmd_buf, cmd, sizeof(cmd_buf));
+  cmd_seq = cmd_seq + 1;
+}
+
+void espnow_ctrl_init()
+{
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();   // radio on, no association needed
+
+  if (esp_now_init() != ESP_OK) {
+    Serial.println("esp_now_init failed, remote control disabled");
+    return;
+  }
+  esp_now_register_recv_cb(onEspNowRecv);
+  Serial.print("ESP-NOW listening on ");
+  Serial.println(WiFi.macAddress());
+}
+
+bool espnow_ctrl_poll(struct spider_cmd *out)
+{
+  uint32_t seq = cmd_seq;
+  if (seq == cmd_seen) {
+    return false;
+  }
+  do {
+    seq = cmd_seq;
+    memcpy(out, (const void *)&cmd_buf, sizeof(*out));
+  } while (seq != cmd_seq);  // re-copy if the callback raced us
+  cmd_seen = seq;
+  return true;
+}
@@ -0,0 +1,30 @@
+/* ESP-NOW control channel for the spiderbot.
+
+   Connectionless peer frames go straight from the radio to the gait
+   engine's target buffer — no association, no TCP/IP stack, so a
+   command is in hand well under 5ms after the transmitter sends it.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#define SPIDER_CMD_MAGIC      0x5B
+#define SPIDER_CMD_GAIT       0  /* set gait rate / pause */
+#define SPIDER_CMD_POSE       1  /* direct pose: 12 joint angles */
+
+struct __attribute__((packed)) spider_cmd {
+  uint8_t magic;       /* SPIDER_CMD_MAGIC */
+  uint8_t type;        /* SPIDER_CMD_* */
+  uint8_t gait_hz;     /* GAIT: tick rate, 0 pauses the gait */
+  uint8_t joints[12];  /* POSE: degrees, leg-major like servo_pin */
+};
+
+/* Brings the radio up in STA mode and starts listening. Any peer that
+   knows our MAC can send; frames failing the magic/length check are
+   dropped. */
+void espnow_ctrl_init();
+
+/* Copies the newest command into *out and returns true if one arrived
+   since the last poll. Latest-wins: stale commands are overwritten by
+   the receive callback, never queued. */
+bool espnow_ctrl_poll(struct spider_cmd *out);
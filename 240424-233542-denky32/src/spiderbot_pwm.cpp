@@ -14,30 +14,139 @@
 #include <Wire.h>
 // Inlude motor control functions
 #include "motorControl.h"
+// Async logging so the per-servo prints don't stall the sweep timing
+#include "ring_log.h"
+// ESP-NOW remote commands, straight into the gait targets
+#include "espnow_ctrl.h"
 
 
 //define servo pins
 const int servo_pin[4][3] = { {0, 1, 2}, {4, 3, 5}, {7, 6, 8}, {10, 9, 11} };
 
-void setup() 
+/* Gait engine: the old loop walked one joint per delay(20), so a full
+ * pose took ~250ms and nothing else could run meanwhile. Now the leg
+ * trajectories are precomputed into a phase-indexed table at startup,
+ * a hardware timer advances the phase at GAIT_RATE_HZ, and loop()
+ * just latches the current pose with one burst write when the tick
+ * flag is set — the rest of the time it's free for sensing and comms. */
+#define GAIT_STEPS      64
+#define GAIT_RATE_HZ    50
+#define HIP_CENTER      90
+#define HIP_SWING       25
+#define KNEE_CENTER     90
+#define KNEE_LIFT       30
+
+static uint8_t gait_table[GAIT_STEPS][4][3];
+
+static hw_timer_t *gait_timer = NULL;
+static volatile uint32_t gait_phase = 0;
+static volatile bool gait_tick_pending = false;
+// Paused (or posed via ESP-NOW) when false; the timer keeps running so
+// resume is just flipping the flag.
+static bool gait_enabled = true;
+
+// Tripod gait: legs 0/3 run half a cycle ahead of legs 1/2. Hips sweep
+// a full sine, knees lift only during the swing half of the cycle.
+static void buildGaitTable()
+{
+  for (int s = 0; s < GAIT_STEPS; s++)
+  {
+    for (int leg = 0; leg < 4; leg++)
+    {
+      int phase = s;
+      if (leg == 1 || leg == 2) {
+        phase = (s + GAIT_STEPS / 2) % GAIT_STEPS;
+      }
+      float a = 2 * PI * phase / GAIT_STEPS;
+      int hip = HIP_CENTER + int(HIP_SWING * sin(a));
+      int knee = KNEE_CENTER;
+      if (phase < GAIT_STEPS / 2) {
+        knee += int(KNEE_LIFT * sin(2 * a));
+      }
+      gait_table[s][leg][0] = hip;
+      gait_table[s][leg][1] = knee;
+      gait_table[s][leg][2] = KNEE_CENTER;
+    }
+  }
+}
+
+// Only advances the phase; the I2C write happens in loop() because
+// Wire must not be used from an ISR.
+static void IRAM_ATTR onGaitTick()
+{
+  gait_phase = (gait_phase + 1) % GAIT_STEPS;
+  gait_tick_pending = true;
+}
+
+void setup()
 {
   Serial.begin(9600);
+  ring_log_init();
   motorInit();
+  buildGaitTable();
+
+  // 80MHz / 80 = 1MHz timer base, alarm period in microseconds
+  gait_timer = timerBegin(0, 80, true);
+  timerAttachInterrupt(gait_timer, &onGaitTick, true);
+  timerAlarmWrite(gait_timer, 1000000 / GAIT_RATE_HZ, true);
+  timerAlarmEnable(gait_timer);
+
+  espnow_ctrl_init();
+}
+
+// Commands land in the gait engine between ticks: a GAIT command
+// retunes or pauses the phase clock, a POSE command freezes the gait
+// and latches the commanded joints directly.
+static void handleCommand(const struct spider_cmd &cmd)
+{
+  if (cmd.type == SPIDER_CMD_GAIT)
+  {
+    if (cmd.gait_hz == 0) {
+      gait_enabled = false;
+    } else {
+      int hz = constrain(cmd.gait_hz, 10, 100);
+      timerAlarmWrite(gait_timer, 1000000 / hz, true);
+      gait_enabled = true;
+    }
+    ring_log("cmd gait %u Hz", cmd.gait_hz);
+  }
+  else if (cmd.type == SPIDER_CMD_POSE)
+  {
+    gait_enabled = false;
+    for (int i = 0; i < 4; i++)
+    {
+      for (int j = 0; j < 3; j++)
+      {
+        setServoTarget(cmd.joints[i * 3 + j], servo_pin [i][j]);
+      }
+    }
+    setAllServos();
+    ring_log("cmd pose latched");
+  }
 }
 
 
 void loop() {
-  for (int i = 0; i < 4; i++)
+  struct spider_cmd cmd;
+  if (espnow_ctrl_poll(&cmd)) {
+    handleCommand(cmd);
+  }
+
+  if (gait_tick_pending && gait_enabled)
   {
-    for (int j = 0; j < 3; j++)
+    gait_tick_pending = false;
+    uint32_t phase = gait_phase;
+    for (int i = 0; i < 4; i++)
     {
-      moveMotorDegrees(90, servo_pin [i][j]);
-      Serial.print("setmotor ");
-      Serial.print(servo_pin [i][j]);
-       Serial.println(".");
-   //   servo[i][j].write(90);
-      delay(20);
+      for (int j = 0; j < 3; j++)
+      {
+        setServoTarget(gait_table[phase][i][j], servo_pin [i][j]);
+      }
+    }
+    setAllServos();
+    if (phase == 0) {
+      ring_log("gait cycle complete");
     }
   }
-
+  // Free for sensing between ticks; commands arrive via ESP-NOW.
 }
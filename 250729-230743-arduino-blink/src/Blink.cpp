@@ -1,11 +1,215 @@
 /*
- * Blink
- * Turns on an LED on for one second,
- * then off for one second, repeatedly.
+ * Blink, grown into the shared benchmark rig.
+ *
+ * On ESP32 (env:denky32) this is a microbenchmark and jitter harness:
+ * before/after numbers for the performance work elsewhere in this tree
+ * all come from the same measurements on the same board.
+ *
+ *  - loop-latency: time between loop() entries, with a GPIO toggle per
+ *    pass so a scope can cross-check the serial numbers
+ *  - ISR jitter: a 1 kHz hardware timer records how far each tick
+ *    lands from the previous one
+ *  - candidate kernels under cycle-count timers: the degree-to-pulse
+ *    math from the spiderbot's motorControl.h (float vs lookup table)
+ *    and the multipart part-header formatting from ESP32_cam's
+ *    stream_handler (snprintf vs cached prefix)
+ *
+ * Results go out as CSV histograms on the serial port every few
+ * seconds. On the AVR targets this stays the original blink so those
+ * envs keep building.
  */
 
 #include <Arduino.h>
 
+#ifdef ESP32
+
+#define BENCH_PIN        LED_BUILTIN
+#define BENCH_ITERS      1000
+#define HIST_BUCKETS     24
+#define REPORT_MS        5000
+
+/* Log2-bucketed histogram: bucket n holds samples in [2^n, 2^(n+1)). */
+struct Hist {
+  uint32_t bucket[HIST_BUCKETS];
+  uint32_t count;
+  uint32_t min_v;
+  uint32_t max_v;
+  uint64_t sum;
+};
+
+static void histReset(Hist &h)
+{
+  memset(&h, 0, sizeof(h));
+  h.min_v = UINT32_MAX;
+}
+
+static void histAdd(Hist &h, uint32_t v)
+{
+  int b = 0;
+  for (uint32_t x = v; x > 1 && b < HIST_BUCKETS - 1; x >>= 1) b++;
+  h.bucket[b]++;
+  h.count++;
+  h.sum += v;
+  if (v < h.min_v) h.min_v = v;
+  if (v > h.max_v) h.max_v = v;
+}
+
+// CSV: name,unit,count,min,avg,max then one hist line of bucket counts
+static void histPrint(const char *name, const char *unit, const Hist &h)
+{
+  Serial.printf("%s,%s,%lu,%lu,%lu,%lu\n", name, unit,
+                (unsigned long)h.count, (unsigned long)h.min_v,
+                (unsigned long)(h.count ? h.sum / h.count : 0),
+                (unsigned long)h.max_v);
+  Serial.printf("%s_hist", name);
+  for (int i = 0; i < HIST_BUCKETS; i++) {
+    Serial.printf(",%lu", (unsigned long)h.bucket[i]);
+  }
+  Serial.println();
+}
+
+/* ---- ISR jitter ----------------------------------------------------- */
+
+static hw_timer_t *jitter_timer = NULL;
+static volatile uint32_t isr_last_cycles = 0;
+static volatile uint32_t isr_delta[BENCH_ITERS];
+static volatile uint16_t isr_samples = 0;
+
+static void IRAM_ATTR onJitterTick()
+{
+  uint32_t now = ESP.getCycleCount();
+  if (isr_last_cycles != 0 && isr_samples < BENCH_ITERS) {
+    isr_delta[isr_samples++] = now - isr_last_cycles;
+  }
+  isr_last_cycles = now;
+}
+
+/* ---- candidate kernels ---------------------------------------------- */
+
+// spiderbot motorControl.h constants, copied so the rig is stand-alone
+#define MIN_PULSE_WIDTH  600
+#define MAX_PULSE_WIDTH  2200
+#define FREQUENCY        50
+
+static volatile int sink_i;
+
+// the original float path of moveMotorDegrees
+static void kernelDegreesFloat()
+{
+  int pulse_wide = map(sink_i & 0xB4, 0, 180, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+  sink_i = int(float(pulse_wide) / 1000000 * FREQUENCY * 4096);
+}
+
+// the lookup-table replacement
+static uint16_t deg_ticks[181];
+
+static void kernelDegreesLut()
+{
+  sink_i = deg_ticks[sink_i % 181];
+}
+
+// ESP32_cam stream_handler part header: snprintf per frame...
+static char part_buf[64];
+
+static void kernelPartSnprintf()
+{
+  sink_i = snprintf(part_buf, 64,
+                    "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                    (unsigned)(sink_i & 0xFFFFF));
+}
+
+// ...versus patching digits into a cached prefix
+#define PART_PREFIX "Content-Type: image/jpeg\r\nContent-Length: "
+
+static void kernelPartPatch()
+{
+  static const size_t pfx = sizeof(PART_PREFIX) - 1;
+  unsigned v = (unsigned)(sink_i & 0xFFFFF);
+  char *p = part_buf + pfx;
+  do { *p++ = '0' + v % 10; v /= 10; } while (v);
+  *p++ = '\r'; *p++ = '\n'; *p++ = '\r'; *p++ = '\n';
+  sink_i = p - part_buf;
+}
+
+static void benchKernel(const char *name, void (*kernel)())
+{
+  Hist h;
+  histReset(h);
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    uint32_t t0 = ESP.getCycleCount();
+    kernel();
+    histAdd(h, ESP.getCycleCount() - t0);
+  }
+  histPrint(name, "cycles", h);
+}
+
+/* ---- harness -------------------------------------------------------- */
+
+static Hist loop_hist;
+static uint32_t loop_last_us = 0;
+static uint32_t report_last_ms = 0;
+static bool bench_pin_state = false;
+
+void setup()
+{
+  Serial.begin(115200);
+  pinMode(BENCH_PIN, OUTPUT);
+
+  for (int d = 0; d <= 180; d++) {
+    long w = MIN_PULSE_WIDTH + (long)(MAX_PULSE_WIDTH - MIN_PULSE_WIDTH) * d / 180;
+    deg_ticks[d] = (uint16_t)(w * FREQUENCY * 4096L / 1000000L);
+  }
+  memcpy(part_buf, PART_PREFIX, sizeof(PART_PREFIX) - 1);
+  histReset(loop_hist);
+
+  // 1 kHz tick off the 1 MHz timer base
+  jitter_timer = timerBegin(0, 80, true);
+  timerAttachInterrupt(jitter_timer, &onJitterTick, true);
+  timerAlarmWrite(jitter_timer, 1000, true);
+  timerAlarmEnable(jitter_timer);
+
+  Serial.println("name,unit,count,min,avg,max");
+}
+
+void loop()
+{
+  // scope cross-check: one edge per loop pass
+  bench_pin_state = !bench_pin_state;
+  digitalWrite(BENCH_PIN, bench_pin_state);
+
+  uint32_t now = micros();
+  if (loop_last_us != 0) {
+    histAdd(loop_hist, now - loop_last_us);
+  }
+  loop_last_us = now;
+
+  if (millis() - report_last_ms >= REPORT_MS) {
+    report_last_ms = millis();
+
+    histPrint("loop_latency", "us", loop_hist);
+    histReset(loop_hist);
+
+    // drain the ISR deltas collected since the last report
+    Hist jh;
+    histReset(jh);
+    uint16_t n = isr_samples;
+    for (uint16_t i = 0; i < n; i++) {
+      histAdd(jh, isr_delta[i]);
+    }
+    isr_samples = 0;
+    histPrint("isr_period", "cycles", jh);
+
+    benchKernel("degrees_float", kernelDegreesFloat);
+    benchKernel("degrees_lut", kernelDegreesLut);
+    benchKernel("part_snprintf", kernelPartSnprintf);
+    benchKernel("part_patch", kernelPartPatch);
+
+    loop_last_us = 0;  // don't count the reporting pass itself
+  }
+}
+
+#else /* !ESP32: the original blink, so the AVR envs keep building */
+
 void setup()
 {
   // initialize LED digital pin as an output.
@@ -23,3 +227,5 @@ void loop()
    // wait for a second
   delay(1000);
 }
+
+#endif
@@ -0,0 +1,222 @@
+#include <Arduino.h>
+
+/*
+ *  ColorReader: on-device BLE collector for the color sensor.
+ *
+ *  Replaces the host-side Python reader (see ../traffic_log.txt),
+ *  which paid a host round-trip per sample and kept losing the link
+ *  ("Notify skipped ... Not connected"). This is a NimBLE central
+ *  that holds the connection open, subscribes to the sensor's
+ *  notify/indicate characteristics, and stashes every update into a
+ *  fixed ring buffer from the BLE host task. loop() drains the ring
+ *  and ships batched binary records over serial, so no sample waits
+ *  on the host and reconnects are automatic instead of data holes.
+ *
+ *  Batch framing (little-endian):
+ *    "CRB1" | u16 seq | u16 count | u16 dropped | count * sample
+ *  sample:
+ *    u32 t_ms | u8 src | u8 len | u8 data[20]
+ */
+#include <NimBLEDevice.h>
+
+// Sensor identity, from the GATT dump in traffic_log.txt
+#define SENSOR_ADDR       "34:32:e6:3b:65:86"
+static const NimBLEUUID SVC_COLOR("da2b84f1-6279-48de-bdc0-afbea0226079");
+static const NimBLEUUID CHR_COLOR_IND("18cda784-4bd3-4370-85bb-bfed91ec86af");
+static const NimBLEUUID CHR_COLOR_NTF("fdd6b4d3-046d-4330-bdec-1fd0c90cb43b");
+static const NimBLEUUID SVC_BATTERY((uint16_t)0x180f);
+static const NimBLEUUID CHR_BATTERY((uint16_t)0x2a19);
+
+// Source tags in the sample records
+#define SRC_COLOR_IND     0
+#define SRC_COLOR_NTF     1
+#define SRC_BATTERY       2
+
+/* ---- sample ring ----------------------------------------------------
+ * Single producer (NimBLE host task, notify callbacks) / single
+ * consumer (loop). Head/tail are free-running indices; when the ring
+ * is full the newest sample is dropped and counted, so the producer
+ * never blocks inside the stack's callback. */
+
+#define SAMPLE_DATA_MAX   20
+#define RING_SIZE         256   // power of two
+#define BATCH_SAMPLES     32    // flush threshold
+#define BATCH_MS          1000  // ...or at least this often
+
+struct __attribute__((packed)) sample_rec {
+  uint32_t t_ms;
+  uint8_t src;
+  uint8_t len;
+  uint8_t data[SAMPLE_DATA_MAX];
+};
+
+static sample_rec ring[RING_SIZE];
+static volatile uint32_t ring_head = 0;  // producer
+static volatile uint32_t ring_tail = 0;  // consumer
+static volatile uint32_t ring_dropped = 0;
+
+static void ringPush(uint8_t src, const uint8_t *data, size_t len)
+{
+  uint32_t head = ring_head;
+  if (head - ring_tail >= RING_SIZE) {
+    ring_dropped = ring_dropped + 1;
+    return;
+  }
+  sample_rec &s = ring[head % RING_SIZE];
+  s.t_ms = millis();
+  s.src = src;
+  s.len = (len > SAMPLE_DATA_MAX) ? SAMPLE_DATA_MAX : len;
+  memcpy(s.data, data, s.len);
+  ring_head = head + 1;
+}
+
+/* ---- batched delivery ----------------------------------------------- */
+
+static uint16_t batch_seq = 0;
+static uint32_t batch_last_ms = 0;
+
+static void flushBatch()
+{
+  uint32_t avail = ring_head - ring_tail;
+  if (avail == 0) {
+    batch_last_ms = millis();
+    return;
+  }
+  if (avail > BATCH_SAMPLES) {
+    avail = BATCH_SAMPLES;
+  }
+
+  uint16_t dropped = ring_dropped;
+  ring_dropped = 0;
+
+  uint8_t hdr[10] = { 'C', 'R', 'B', '1' };
+  hdr[4] = batch_seq & 0xFF;
+  hdr[5] = batch_seq >> 8;
+  hdr[6] = avail & 0xFF;
+  hdr[7] = avail >> 8;
+  hdr[8] = dropped & 0xFF;
+  hdr[9] = dropped >> 8;
+  Serial.write(hdr, sizeof(hdr));
+  for (uint32_t i = 0; i < avail; i++) {
+    Serial.write((const uint8_t *)&ring[ring_tail % RING_SIZE], sizeof(sample_rec));
+    ring_tail = ring_tail + 1;
+  }
+  batch_seq++;
+  batch_last_ms = millis();
+}
+
+/* ---- BLE central ---------------------------------------------------- */
+
+static NimBLEClient *client = NULL;
+static volatile bool link_up = false;
+static uint32_t reconnect_count = 0;
+
+static void onColorIndicate(NimBLERemoteCharacteristic *c, uint8_t *data,
+                            size_t len, bool isNotify)
+{
+  ringPush(SRC_COLOR_IND, data, len);
+}
+
+static void onColorNotify(NimBLERemoteCharacteristic *c, uint8_t *data,
+                          size_t len, bool isNotify)
+{
+  ringPush(SRC_COLOR_NTF, data, len);
+}
+
+static void onBatteryNotify(NimBLERemoteCharacteristic *c, uint8_t *data,
+                            size_t len, bool isNotify)
+{
+  ringPush(SRC_BATTERY, data, len);
+}
+
+class ClientCallbacks : public NimBLEClientCallbacks {
+  void onConnect(NimBLEClient *c) {
+    link_up = true;
+  }
+  void onDisconnect(NimBLEClient *c) {
+    // loop() notices and reconnects; no work in the stack's callback
+    link_up = false;
+  }
+};
+
+static bool subscribeChar(const NimBLEUUID &svc, const NimBLEUUID &chr,
+                          notify_callback cb)
+{
+  NimBLERemoteService *s = client->getService(svc);
+  if (s == NULL) {
+    return false;
+  }
+  NimBLERemoteCharacteristic *c = s->getCharacteristic(chr);
+  if (c == NULL) {
+    return false;
+  }
+  // prefer notifications, fall back to indications (the fdd6b4d3
+  // characteristic offers both, 18cda784 is indicate-only)
+  if (c->canNotify()) {
+    return c->subscribe(true, cb);
+  }
+  if (c->canIndicate()) {
+    return c->subscribe(false, cb);
+  }
+  return false;
+}
+
+static bool connectSensor()
+{
+  if (client == NULL) {
+    client = NimBLEDevice::createClient();
+    client->setClientCallbacks(new ClientCallbacks(), false);
+    client->setConnectTimeout(10);
+  }
+
+  Serial.printf("# connecting to %s\n", SENSOR_ADDR);
+  if (!client->connect(NimBLEAddress(SENSOR_ADDR))) {
+    return false;
+  }
+
+  bool any = false;
+  any |= subscribeChar(SVC_COLOR, CHR_COLOR_NTF, onColorNotify);
+  any |= subscribeChar(SVC_COLOR, CHR_COLOR_IND, onColorIndicate);
+  subscribeChar(SVC_BATTERY, CHR_BATTERY, onBatteryNotify);
+  if (!any) {
+    // wrong device or changed firmware: don't sit on a silent link
+    Serial.println("# no color characteristics found, disconnecting");
+    client->disconnect();
+    return false;
+  }
+
+  Serial.printf("# connected, reconnects so far: %lu\n",
+                (unsigned long)reconnect_count);
+  return true;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  NimBLEDevice::init("colorreader");
+  NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+
+  batch_last_ms = millis();
+  while (!connectSensor()) {
+    delay(2000);
+  }
+}
+
+void loop()
+{
+  if (!link_up) {
+    reconnect_count++;
+    flushBatch();  // don't hold samples across the reconnect attempt
+    if (!connectSensor()) {
+      delay(2000);
+      return;
+    }
+  }
+
+  uint32_t avail = ring_head - ring_tail;
+  if (avail >= BATCH_SAMPLES || millis() - batch_last_ms >= BATCH_MS) {
+    flushBatch();
+  }
+  delay(10);
+}
@@ -15,6 +15,12 @@
 #include "soc/rtc_cntl_reg.h"    // disable brownout problems
 #include "esp_http_server.h"
 #include <ESP32Servo.h>
+#include <Preferences.h>
+#include "lwip/sockets.h"
+#include "stream_broadcaster.h"
+#include "rtp_stream.h"
+#include "sd_recorder.h"
+#include "ring_log.h"
 
 // Replace with your network credentials
 const char* ssid = "rubidium2g_RPT";
@@ -131,19 +137,91 @@ const char* password = "Echomonkeyfuture859";
 #define SERVO_2      15
 
 #define SERVO_STEP   5
+#define SERVO_TICK_HZ 50
 
 Servo servo1;
 Servo servo2;
 
-int servo1Pos = 0;
-int servo2Pos = 0;
+// Easing scheduler state: handlers set a target and velocity once and a
+// 50 Hz esp_timer callback interpolates the writes, so one request per
+// gesture replaces a flood of step requests. Positions are tracked in
+// centidegrees so sub-degree-per-tick speeds still move.
+static volatile int servo1Target = 0;   // degrees
+static volatile int servo2Target = 0;
+static volatile int servoSpeed = 120;   // degrees per second
+static int servo1Cur = 0;               // centidegrees
+static int servo2Cur = 0;
+static esp_timer_handle_t servoTimer = NULL;
+
+static int easeToward(int cur, int target100, int step, Servo &servo){
+  if(cur == target100){
+    return cur;
+  }
+  if(cur < target100){
+    cur += step;
+    if(cur > target100) cur = target100;
+  } else {
+    cur -= step;
+    if(cur < target100) cur = target100;
+  }
+  servo.write(cur / 100);
+  return cur;
+}
+
+static void servoTick(void *arg){
+  int step = (servoSpeed * 100) / SERVO_TICK_HZ;
+  if(step < 1) step = 1;
+  servo1Cur = easeToward(servo1Cur, servo1Target * 100, step, servo1);
+  servo2Cur = easeToward(servo2Cur, servo2Target * 100, step, servo2);
+}
+
+// Frame size picked in setup(), needed to size the broadcaster's
+// conversion buffer pool.
+static framesize_t streamFrameSize = FRAMESIZE_QVGA;
 
 static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
 static const char* _STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
 static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
 
+// Per-frame header cache: the part header is preformatted once for each
+// Content-Length digit count, so the hot loop only memcpys the template
+// and patches the digits in place instead of running snprintf per frame.
+#define STREAM_PART_PREFIX "Content-Type: image/jpeg\r\nContent-Length: "
+#define STREAM_PART_MAX_DIGITS 8
+
+static char _stream_part_cache[STREAM_PART_MAX_DIGITS + 1][64];
+static size_t _stream_part_cache_len[STREAM_PART_MAX_DIGITS + 1];
+static size_t _stream_boundary_len = 0;
+
+static void initStreamHeaderCache(){
+  _stream_boundary_len = strlen(_STREAM_BOUNDARY);
+  for(int d = 1; d <= STREAM_PART_MAX_DIGITS; d++){
+    char digits[STREAM_PART_MAX_DIGITS + 1];
+    memset(digits, '0', d);
+    digits[d] = '\0';
+    _stream_part_cache_len[d] = snprintf(_stream_part_cache[d], 64,
+        STREAM_PART_PREFIX "%s\r\n\r\n", digits);
+  }
+}
+
+static size_t buildStreamPartHeader(char *dst, size_t jpg_len){
+  int digits = 1;
+  for(size_t v = jpg_len; v >= 10; v /= 10) digits++;
+  if(digits > STREAM_PART_MAX_DIGITS){
+    return snprintf(dst, 64, _STREAM_PART, jpg_len);
+  }
+  size_t hlen = _stream_part_cache_len[digits];
+  memcpy(dst, _stream_part_cache[digits], hlen);
+  char *p = dst + sizeof(STREAM_PART_PREFIX) - 1 + digits;
+  size_t v = jpg_len;
+  while(digits-- > 0){
+    *--p = '0' + (v % 10);
+    v /= 10;
+  }
+  return hlen;
+}
+
 httpd_handle_t camera_httpd = NULL;
-httpd_handle_t stream_httpd = NULL;
 
 static const char PROGMEM INDEX_HTML[] = R"rawliteral(
 <html>
@@ -193,7 +271,7 @@ static const char PROGMEM INDEX_HTML[] = R"rawliteral(
      xhr.open("GET", "/action?go=" + x, true);
      xhr.send();
    }
-   window.onload = document.getElementById("photo").src = window.location.href.slice(0, -1) + ":81/stream";
+   window.onload = document.getElementById("photo").src = "/stream";
   </script>
   </body>
 </html>
@@ -204,70 +282,240 @@ static esp_err_t index_handler(httpd_req_t *req){
   return httpd_resp_send(req, (const char *)INDEX_HTML, strlen(INDEX_HTML));
 }
 
-static esp_err_t stream_handler(httpd_req_t *req){
-  camera_fb_t * fb = NULL;
+// Runs on its own task so a long-lived stream never occupies the single
+// httpd worker; the request was detached with the async handler API.
+static void stream_sender_task(void *arg){
+  httpd_req_t *req = (httpd_req_t *)arg;
   esp_err_t res = ESP_OK;
-  size_t _jpg_buf_len = 0;
-  uint8_t * _jpg_buf = NULL;
   char * part_buf[64];
 
   res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
   if(res != ESP_OK){
-    return res;
+    httpd_req_async_handler_complete(req);
+    vTaskDelete(NULL);
+    return;
+  }
+
+  bc_session_t *session = broadcaster_session_open();
+  if(!session){
+    Serial.println("Too many stream clients");
+    httpd_resp_send_500(req);
+    httpd_req_async_handler_complete(req);
+    vTaskDelete(NULL);
+    return;
   }
 
   while(true){
-    fb = esp_camera_fb_get();
-    if (!fb) {
-      Serial.println("Camera capture failed");
-      res = ESP_FAIL;
-    } else {
-      if(fb->width > 400){
-        if(fb->format != PIXFORMAT_JPEG){
-          bool jpeg_converted = frame2jpg(fb, 80, &_jpg_buf, &_jpg_buf_len);
-          esp_camera_fb_return(fb);
-          fb = NULL;
-          if(!jpeg_converted){
-            Serial.println("JPEG compression failed");
-            res = ESP_FAIL;
-          }
-        } else {
-          _jpg_buf_len = fb->len;
-          _jpg_buf = fb->buf;
-        }
-      }
+    bc_frame_t *frame = broadcaster_session_next(session, portMAX_DELAY);
+    if(!frame){
+      continue;
     }
+    int64_t send_start = esp_timer_get_time();
+    size_t hlen = buildStreamPartHeader((char *)part_buf, frame->jpg_len);
+    res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
     if(res == ESP_OK){
-      size_t hlen = snprintf((char *)part_buf, 64, _STREAM_PART, _jpg_buf_len);
-      res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+      res = httpd_resp_send_chunk(req, (const char *)frame->jpg_buf, frame->jpg_len);
     }
     if(res == ESP_OK){
-      res = httpd_resp_send_chunk(req, (const char *)_jpg_buf, _jpg_buf_len);
+      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, _stream_boundary_len);
     }
+    broadcaster_frame_release(frame);
     if(res == ESP_OK){
-      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+      broadcaster_report_send_us((uint32_t)(esp_timer_get_time() - send_start));
+    }
+    if(res != ESP_OK){
+      break;
     }
-    if(fb){
-      esp_camera_fb_return(fb);
-      fb = NULL;
-      _jpg_buf = NULL;
-    } else if(_jpg_buf){
-      free(_jpg_buf);
-      _jpg_buf = NULL;
+    broadcaster_session_mark_sent(session);
+    //Serial.printf("MJPG: %uB\n",(uint32_t)(frame->jpg_len));
+  }
+  broadcaster_session_close(session);
+  httpd_req_async_handler_complete(req);
+  vTaskDelete(NULL);
+}
+
+// WebSocket transport: each JPEG goes out as one binary frame, so there
+// is no per-frame multipart header to format and only one send per frame,
+// and the client gets frame boundaries from the protocol itself.
+typedef struct {
+  httpd_handle_t hd;
+  int fd;
+} ws_client_t;
+
+static void ws_stream_task(void *arg){
+  ws_client_t client = *(ws_client_t *)arg;
+  free(arg);
+  bc_session_t *session = broadcaster_session_open();
+  if(!session){
+    Serial.println("Too many stream clients");
+    httpd_sess_trigger_close(client.hd, client.fd);
+    vTaskDelete(NULL);
+    return;
+  }
+  while(true){
+    bc_frame_t *frame = broadcaster_session_next(session, portMAX_DELAY);
+    if(!frame){
+      continue;
     }
+    httpd_ws_frame_t ws_pkt;
+    memset(&ws_pkt, 0, sizeof(ws_pkt));
+    ws_pkt.type = HTTPD_WS_TYPE_BINARY;
+    ws_pkt.payload = frame->jpg_buf;
+    ws_pkt.len = frame->jpg_len;
+    int64_t send_start = esp_timer_get_time();
+    esp_err_t res = httpd_ws_send_frame_async(client.hd, client.fd, &ws_pkt);
+    broadcaster_frame_release(frame);
     if(res != ESP_OK){
       break;
     }
-    //Serial.printf("MJPG: %uB\n",(uint32_t)(_jpg_buf_len));
+    broadcaster_session_mark_sent(session);
+    broadcaster_report_send_us((uint32_t)(esp_timer_get_time() - send_start));
   }
+  broadcaster_session_close(session);
+  vTaskDelete(NULL);
+}
+
+static esp_err_t ws_handler(httpd_req_t *req){
+  if(req->method == HTTP_GET){
+    // Handshake done; hand the socket to a sender task.
+    ws_client_t *client = (ws_client_t *)malloc(sizeof(ws_client_t));
+    if(!client){
+      return ESP_ERR_NO_MEM;
+    }
+    client->hd = req->handle;
+    client->fd = httpd_req_to_sockfd(req);
+    if(xTaskCreatePinnedToCore(ws_stream_task, "ws_send", 4096,
+                               client, 5, NULL, 1) != pdPASS){
+      free(client);
+      return ESP_FAIL;
+    }
+    return ESP_OK;
+  }
+  // Inbound frames are not part of the protocol; drain and ignore them.
+  httpd_ws_frame_t ws_pkt;
+  memset(&ws_pkt, 0, sizeof(ws_pkt));
+  return httpd_ws_recv_frame(req, &ws_pkt, 0);
+}
+
+static esp_err_t stream_handler(httpd_req_t *req){
+  httpd_req_t *async_req = NULL;
+  if(httpd_req_async_handler_begin(req, &async_req) != ESP_OK){
+    return httpd_resp_send_500(req);
+  }
+  if(xTaskCreatePinnedToCore(stream_sender_task, "stream_send", 4096,
+                             async_req, 5, NULL, 1) != pdPASS){
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+// /record?interval=500 starts the SD time-lapse at one frame per
+// interval (ms); interval=0 stops and finalises the file.
+static esp_err_t record_handler(httpd_req_t *req){
+  char buf[32];
+  char val[8] = {0,};
+  if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) != ESP_OK ||
+      httpd_query_key_value(buf, "interval", val, sizeof(val)) != ESP_OK) {
+    httpd_resp_send_404(req);
+    return ESP_FAIL;
+  }
+  int interval = atoi(val);
+  if (interval <= 0) {
+    sd_recorder_stop();
+    return httpd_resp_sendstr(req, "recording stopped");
+  }
+  if (sd_recorder_start(interval) != ESP_OK) {
+    return httpd_resp_send_500(req);
+  }
+  return httpd_resp_sendstr(req, "recording started");
+}
+
+// /rtp?port=N starts RTP/MJPEG towards the requester's address on that
+// UDP port; port=0 stops the sender.
+static esp_err_t rtp_handler(httpd_req_t *req){
+  char buf[32];
+  char val[8] = {0,};
+  if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) != ESP_OK ||
+      httpd_query_key_value(buf, "port", val, sizeof(val)) != ESP_OK) {
+    httpd_resp_send_404(req);
+    return ESP_FAIL;
+  }
+  int port = atoi(val);
+  if (port <= 0) {
+    rtp_stream_stop();
+    return httpd_resp_sendstr(req, "rtp stopped");
+  }
+  struct sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
+  if (getpeername(httpd_req_to_sockfd(req), (struct sockaddr *)&addr,
+                  &addr_len) != 0) {
+    return httpd_resp_send_500(req);
+  }
+  uint32_t ip;
+  if (addr.ss_family == AF_INET) {
+    ip = ((struct sockaddr_in *)&addr)->sin_addr.s_addr;
+  } else {
+    // v4-mapped address on dual-stack builds
+    ip = ((struct sockaddr_in6 *)&addr)->sin6_addr.un.u32_addr[3];
+  }
+  if (rtp_stream_start(ip, (uint16_t)port) != ESP_OK) {
+    return httpd_resp_send_500(req);
+  }
+  return httpd_resp_sendstr(req, "rtp started");
+}
+
+// Serves the most recent broadcast frame without touching the camera, so
+// polling dashboards cost a memcpy instead of a capture.
+static esp_err_t snapshot_handler(httpd_req_t *req){
+  bc_frame_t *frame = broadcaster_latest_frame();
+  if(!frame){
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_send(req, NULL, 0);
+  }
+  httpd_resp_set_type(req, "image/jpeg");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+  esp_err_t res = httpd_resp_send(req, (const char *)frame->jpg_buf, frame->jpg_len);
+  broadcaster_frame_release(frame);
+  return res;
+}
+
+static esp_err_t streams_handler(httpd_req_t *req){
+  char buf[256];
+  size_t len = broadcaster_stats_json(buf, sizeof(buf));
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_send(req, buf, len);
+}
+
+static esp_err_t stats_handler(httpd_req_t *req){
+  char *buf = (char *)malloc(1536);
+  if(!buf){
+    return httpd_resp_send_500(req);
+  }
+  size_t len = broadcaster_timing_json(buf, 1536);
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t res = httpd_resp_send(req, buf, len);
+  free(buf);
   return res;
 }
 
+// Pulls an integer query value, returning fallback when absent.
+static int query_int(const char *query, const char *key, int fallback){
+  char val[8] = {0,};
+  if (httpd_query_key_value(query, key, val, sizeof(val)) != ESP_OK) {
+    return fallback;
+  }
+  return atoi(val);
+}
+
 static esp_err_t cmd_handler(httpd_req_t *req){
   char*  buf;
   size_t buf_len;
   char variable[32] = {0,};
-  
+  int roi_x = 0, roi_y = 0, roi_w = 0, roi_h = 0;
+  int framesize = -1, quality = -1, aec = -1, aec_value = -1;
+  int pan = -1, tilt = -1, speed = -1;
+
   buf_len = httpd_req_get_url_query_len(req) + 1;
   if (buf_len > 1) {
     buf = (char*)malloc(buf_len);
@@ -277,6 +525,17 @@ static esp_err_t cmd_handler(httpd_req_t *req){
     }
     if (httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK) {
       if (httpd_query_key_value(buf, "go", variable, sizeof(variable)) == ESP_OK) {
+        roi_x = query_int(buf, "x", 0);
+        roi_y = query_int(buf, "y", 0);
+        roi_w = query_int(buf, "w", 0);
+        roi_h = query_int(buf, "h", 0);
+        framesize = query_int(buf, "framesize", -1);
+        quality   = query_int(buf, "quality", -1);
+        aec       = query_int(buf, "aec", -1);
+        aec_value = query_int(buf, "aec_value", -1);
+        pan       = query_int(buf, "pan", -1);
+        tilt      = query_int(buf, "tilt", -1);
+        speed     = query_int(buf, "speed", -1);
       } else {
         free(buf);
         httpd_resp_send_404(req);
@@ -302,36 +561,58 @@ static esp_err_t cmd_handler(httpd_req_t *req){
   int res = 0;
   
   if(!strcmp(variable, "up")) {
-    if(servo1Pos <= 170) {
-      servo1Pos += 10;
-      servo1.write(servo1Pos);
+    if(servo1Target <= 170) {
+      servo1Target += 10;
     }
-    Serial.println(servo1Pos);
-    Serial.println("Up");
   }
   else if(!strcmp(variable, "left")) {
-    if(servo2Pos <= 170) {
-      servo2Pos += 10;
-      servo2.write(servo2Pos);
+    if(servo2Target <= 170) {
+      servo2Target += 10;
     }
-    Serial.println(servo2Pos);
-    Serial.println("Left");
   }
   else if(!strcmp(variable, "right")) {
-    if(servo2Pos >= 10) {
-      servo2Pos -= 10;
-      servo2.write(servo2Pos);
+    if(servo2Target >= 10) {
+      servo2Target -= 10;
     }
-    Serial.println(servo2Pos);
-    Serial.println("Right");
   }
   else if(!strcmp(variable, "down")) {
-    if(servo1Pos >= 10) {
-      servo1Pos -= 10;
-      servo1.write(servo1Pos);
+    if(servo1Target >= 10) {
+      servo1Target -= 10;
+    }
+  }
+  else if(!strcmp(variable, "target")) {
+    // One request per gesture: /action?go=target&pan=..&tilt=..&speed=..
+    // The 50 Hz easing timer does the rest.
+    if(tilt >= 0 && tilt <= 180) servo1Target = tilt;
+    if(pan >= 0 && pan <= 180)  servo2Target = pan;
+    if(speed > 0 && speed <= 720) servoSpeed = speed;
+  }
+  else if(!strcmp(variable, "sensor")) {
+    // Live reconfiguration through the sensor API: a framesize or
+    // quality switch costs one frame instead of a camera reinit.
+    // /action?go=sensor&framesize=N&quality=N&aec=0|1&aec_value=N
+    if (!s) {
+      return httpd_resp_send_500(req);
+    }
+    if (framesize >= 0 &&
+        broadcaster_set_framesize((framesize_t)framesize) != ESP_OK) {
+      res = -1;
+    }
+    if (quality >= 0) {
+      s->set_quality(s, quality);
+    }
+    if (aec >= 0) {
+      s->set_exposure_ctrl(s, aec);
     }
-    Serial.println(servo1Pos);
-    Serial.println("Down");
+    if (aec_value >= 0) {
+      s->set_aec_value(s, aec_value);
+    }
+  }
+  else if(!strcmp(variable, "roi")) {
+    // /action?go=roi&x=..&y=..&w=..&h=.. crops the encoded stream;
+    // /action?go=roi with no rectangle clears it.
+    broadcaster_set_roi(roi_x, roi_y, roi_w, roi_h);
+    ring_log("ROI %ux%u@%u,%u", roi_w, roi_h, roi_x, roi_y);
   }
   else {
     res = -1;
@@ -346,8 +627,15 @@ static esp_err_t cmd_handler(httpd_req_t *req){
 }
 
 void startCameraServer(){
+  initStreamHeaderCache();
+  if (broadcaster_start(streamFrameSize) != ESP_OK) {
+    Serial.println("Frame broadcaster start failed");
+  }
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 80;
+  config.core_id = 1;  // keep the send path on the opposite core to capture
+  config.lru_purge_enable = true;  // single instance now serves everything
+  config.max_uri_handlers = 10;    // we register 9; the default 8 is too few
   httpd_uri_t index_uri = {
     .uri       = "/",
     .method    = HTTP_GET,
@@ -367,14 +655,89 @@ void startCameraServer(){
     .handler   = stream_handler,
     .user_ctx  = NULL
   };
+  httpd_uri_t streams_uri = {
+    .uri       = "/streams",
+    .method    = HTTP_GET,
+    .handler   = streams_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t snapshot_uri = {
+    .uri       = "/snapshot",
+    .method    = HTTP_GET,
+    .handler   = snapshot_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t record_uri = {
+    .uri       = "/record",
+    .method    = HTTP_GET,
+    .handler   = record_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t stats_uri = {
+    .uri       = "/stats",
+    .method    = HTTP_GET,
+    .handler   = stats_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t rtp_uri = {
+    .uri       = "/rtp",
+    .method    = HTTP_GET,
+    .handler   = rtp_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t ws_uri = {
+    .uri       = "/ws",
+    .method    = HTTP_GET,
+    .handler   = ws_handler,
+    .user_ctx  = NULL,
+    .is_websocket = true
+  };
   if (httpd_start(&camera_httpd, &config) == ESP_OK) {
-    httpd_register_uri_handler(camera_httpd, &index_uri);
-    httpd_register_uri_handler(camera_httpd, &cmd_uri);
+    const httpd_uri_t *uris[] = {
+      &index_uri, &cmd_uri, &streams_uri, &snapshot_uri, &stream_uri,
+      &ws_uri, &rtp_uri, &stats_uri, &record_uri
+    };
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+      esp_err_t err = httpd_register_uri_handler(camera_httpd, uris[i]);
+      if (err != ESP_OK) {
+        Serial.printf("Failed to register %s: %s\n", uris[i]->uri,
+                      esp_err_to_name(err));
+      }
+    }
   }
-  config.server_port += 1;
-  config.ctrl_port += 1;
-  if (httpd_start(&stream_httpd, &config) == ESP_OK) {
-    httpd_register_uri_handler(stream_httpd, &stream_uri);
+}
+
+// Fast-boot state: association runs event-driven while the camera
+// initialises, and the AP's BSSID/channel are persisted so the next boot
+// (brownout reboots included) does a directed join instead of a scan.
+Preferences wifiPrefs;
+static bool serverStarted = false;
+static bool directedJoin = false;
+
+static void onWiFiEvent(WiFiEvent_t event){
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      wifiPrefs.putBytes("bssid", WiFi.BSSID(), 6);
+      wifiPrefs.putUChar("chan", WiFi.channel());
+      Serial.print("WiFi connected, stream ready at http://");
+      Serial.println(WiFi.localIP());
+      if (!serverStarted) {
+        serverStarted = true;
+        startCameraServer();
+      }
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      if (directedJoin) {
+        // The persisted BSSID/channel may be stale (AP moved channel or
+        // was replaced); fall back to a full-scan join once.
+        directedJoin = false;
+        WiFi.begin(ssid, password);
+      } else {
+        WiFi.reconnect();
+      }
+      break;
+    default:
+      break;
   }
 }
 
@@ -385,12 +748,24 @@ void setup() {
   
   servo1.attach(SERVO_1, 1000, 2000);
   servo2.attach(SERVO_2, 1000, 2000);
-  
-  servo1.write(servo1Pos);
-  servo2.write(servo2Pos);
-  
+
+  servo1.write(0);
+  servo2.write(0);
+
+  // 50 Hz easing timer drives all further servo motion.
+  const esp_timer_create_args_t servoTimerArgs = {
+    .callback = servoTick,
+    .arg = NULL,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "servo_ease"
+  };
+  if (esp_timer_create(&servoTimerArgs, &servoTimer) == ESP_OK) {
+    esp_timer_start_periodic(servoTimer, 1000000 / SERVO_TICK_HZ);
+  }
+
   Serial.begin(115200);
   Serial.setDebugOutput(false);
+  ring_log_init();
   
   camera_config_t config;
   config.ledc_channel = LEDC_CHANNEL_0;
@@ -423,28 +798,29 @@ void setup() {
     config.jpeg_quality = 12;
     config.fb_count = 1;
   }
+  streamFrameSize = config.frame_size;
   
-  // Camera init
- // esp_err_t err = esp_camera_init(&config);
- // if (err != ESP_OK) {
- //   Serial.printf("Camera init failed with error 0x%x", err);
- //    while (true) delay(100); // prevent WDT
- // }
- 
-  // Wi-Fi connection
-  WiFi.begin(ssid, password);
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
-  }
-  Serial.println("");
-  Serial.println("WiFi connected");
-  
-  Serial.print("Camera Stream Ready! Go to: http://");
-  Serial.println(WiFi.localIP());
-  
-  // Start streaming web server
-  startCameraServer();
+  // Kick off WiFi first so the camera initialises while the station
+  // associates. With a persisted BSSID/channel the join is directed (no
+  // scan), which together with the overlap gets us streaming within a
+  // couple of seconds of reset.
+  WiFi.onEvent(onWiFiEvent);
+  wifiPrefs.begin("wifi", false);
+  uint8_t bssid[6];
+  uint8_t chan = wifiPrefs.getUChar("chan", 0);
+  if (chan != 0 && wifiPrefs.getBytes("bssid", bssid, 6) == 6) {
+    directedJoin = true;
+    WiFi.begin(ssid, password, chan, bssid);
+  } else {
+    WiFi.begin(ssid, password);
+  }
+
+  // Camera init overlaps association
+  esp_err_t err = esp_camera_init(&config);
+  if (err != ESP_OK) {
+    Serial.printf("Camera init failed with error 0x%x\n", err);
+  }
+  // The web server starts from the GOT_IP event.
 }
 
 void loop() {
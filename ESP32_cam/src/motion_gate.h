@@ -0,0 +1,33 @@
+/*
+  Motion gate for the stream pipeline.
+
+  Keeps a QQVGA grayscale downsample of the last analysed frame and
+  compares each new frame against it block by block. While the scene is
+  static the broadcaster drops to a keepalive rate instead of encoding
+  and transmitting every frame, which cuts overnight airtime and power.
+*/
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+esp_err_t motion_gate_init(void);
+
+// Decides whether this frame should be broadcast. Returns true on
+// motion, on the first frame, at the keepalive interval, or whenever the
+// gate is disabled.
+bool motion_gate_check(const camera_fb_t *fb);
+
+void motion_gate_set_enabled(bool enabled);
+
+// Frames per keepalive while static; default 1000 ms between frames.
+void motion_gate_set_keepalive_ms(uint32_t keepalive_ms);
+
+// Mean per-pixel difference a block needs before it counts as changed,
+// and how many changed blocks count as motion.
+void motion_gate_set_threshold(uint8_t block_diff, uint8_t min_blocks);
+
+#endif // MOTION_GATE_H
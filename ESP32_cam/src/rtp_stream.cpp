@@ -0,0 +1,219 @@
+#include "rtp_stream.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "stream_broadcaster.h"
+
+#define RTP_MAX_PAYLOAD  1400   // stay under typical WiFi MTU
+#define RTP_PT_JPEG      26
+#define RTP_HDR_LEN      12
+#define JPEG_HDR_LEN     8
+
+// What the packetizer needs out of a baseline JPEG: the two quantization
+// tables (shipped in the first fragment, Q=255 per RFC 2435), the frame
+// geometry and subsampling, and the entropy-coded scan.
+typedef struct {
+  const uint8_t *qtables[2];
+  int num_qtables;
+  const uint8_t *scan;
+  size_t scan_len;
+  uint16_t width;
+  uint16_t height;
+  uint8_t type;  // 0 = 4:2:2, 1 = 4:2:0
+} jpeg_info_t;
+
+static TaskHandle_t s_rtp_task = NULL;
+static volatile uint32_t s_dest_ip = 0;
+static volatile uint16_t s_dest_port = 0;
+static volatile bool s_running = false;
+
+static uint16_t s_seq = 0;
+static uint32_t s_ssrc = 0;
+
+// Minimal baseline-JPEG marker walk. Returns false on anything the RTP
+// payload format cannot describe (progressive, 16-bit qtables, ...).
+static bool parse_jpeg(const uint8_t *buf, size_t len, jpeg_info_t *info) {
+  if (len < 4 || buf[0] != 0xFF || buf[1] != 0xD8) {
+    return false;
+  }
+  memset(info, 0, sizeof(*info));
+  size_t off = 2;
+  while (off + 4 <= len) {
+    if (buf[off] != 0xFF) {
+      return false;
+    }
+    uint8_t marker = buf[off + 1];
+    uint16_t seg_len = ((uint16_t)buf[off + 2] << 8) | buf[off + 3];
+    if (off + 2 + seg_len > len) {
+      return false;
+    }
+    const uint8_t *seg = buf + off + 4;
+    switch (marker) {
+      case 0xDB: {  // DQT, possibly several tables per segment
+        size_t pos = 0;
+        while (pos + 65 <= (size_t)(seg_len - 2) && info->num_qtables < 2) {
+          if ((seg[pos] >> 4) != 0) {
+            return false;  // 16-bit precision table
+          }
+          info->qtables[info->num_qtables++] = seg + pos + 1;
+          pos += 65;
+        }
+        break;
+      }
+      case 0xC0: {  // SOF0, baseline
+        info->height = ((uint16_t)seg[1] << 8) | seg[2];
+        info->width = ((uint16_t)seg[3] << 8) | seg[4];
+        if (seg[5] < 1) {
+          return false;
+        }
+        uint8_t sampling = seg[7];  // first component H/V factors
+        if (sampling == 0x21) {
+          info->type = 0;
+        } else if (sampling == 0x22) {
+          info->type = 1;
+        } else {
+          return false;
+        }
+        break;
+      }
+      case 0xC2:  // progressive, not representable
+        return false;
+      case 0xDA:  // SOS: scan data runs from here to EOI
+        info->scan = seg + (seg_len - 2);
+        info->scan_len = len - (off + 2 + seg_len);
+        if (info->scan_len >= 2 && buf[len - 2] == 0xFF && buf[len - 1] == 0xD9) {
+          info->scan_len -= 2;
+        }
+        return info->num_qtables > 0 && info->width > 0;
+      default:
+        break;
+    }
+    off += 2 + seg_len;
+  }
+  return false;
+}
+
+static void send_frame_rtp(int sock, const struct sockaddr_in *dest,
+                           const uint8_t *jpg, size_t jpg_len) {
+  jpeg_info_t info;
+  if (!parse_jpeg(jpg, jpg_len, &info)) {
+    return;  // frame not packetizable, skip it
+  }
+  uint8_t pkt[RTP_HDR_LEN + JPEG_HDR_LEN + 4 + 128 + RTP_MAX_PAYLOAD];
+  uint32_t timestamp = (uint32_t)(esp_timer_get_time() * 9 / 100);  // 90 kHz
+  size_t frag_off = 0;
+  while (frag_off < info.scan_len) {
+    size_t hdr = 0;
+    bool first = frag_off == 0;
+    size_t budget = RTP_MAX_PAYLOAD;
+    // RTP header
+    pkt[hdr++] = 0x80;
+    pkt[hdr++] = RTP_PT_JPEG;  // marker bit patched below on last packet
+    pkt[hdr++] = s_seq >> 8;
+    pkt[hdr++] = s_seq & 0xFF;
+    s_seq++;
+    pkt[hdr++] = timestamp >> 24;
+    pkt[hdr++] = timestamp >> 16;
+    pkt[hdr++] = timestamp >> 8;
+    pkt[hdr++] = timestamp;
+    pkt[hdr++] = s_ssrc >> 24;
+    pkt[hdr++] = s_ssrc >> 16;
+    pkt[hdr++] = s_ssrc >> 8;
+    pkt[hdr++] = s_ssrc;
+    // JPEG payload header (RFC 2435 s3.1)
+    pkt[hdr++] = 0;  // type-specific
+    pkt[hdr++] = frag_off >> 16;
+    pkt[hdr++] = frag_off >> 8;
+    pkt[hdr++] = frag_off;
+    pkt[hdr++] = info.type;
+    pkt[hdr++] = 255;  // Q: quantization tables in-band on first fragment
+    pkt[hdr++] = info.width / 8;
+    pkt[hdr++] = info.height / 8;
+    if (first) {
+      // Quantization table header + tables
+      size_t qlen = (size_t)info.num_qtables * 64;
+      pkt[hdr++] = 0;  // MBZ
+      pkt[hdr++] = 0;  // 8-bit precision
+      pkt[hdr++] = qlen >> 8;
+      pkt[hdr++] = qlen & 0xFF;
+      for (int t = 0; t < info.num_qtables; t++) {
+        memcpy(pkt + hdr, info.qtables[t], 64);
+        hdr += 64;
+      }
+      budget -= 4 + qlen;
+    }
+    size_t chunk = info.scan_len - frag_off;
+    if (chunk > budget) {
+      chunk = budget;
+    } else {
+      pkt[1] |= 0x80;  // marker: last packet of the frame
+    }
+    memcpy(pkt + hdr, info.scan + frag_off, chunk);
+    sendto(sock, pkt, hdr + chunk, 0, (const struct sockaddr *)dest,
+           sizeof(*dest));
+    frag_off += chunk;
+  }
+}
+
+static void rtp_send_task(void *arg) {
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0) {
+    Serial.println("RTP socket create failed");
+    s_running = false;
+    s_rtp_task = NULL;
+    vTaskDelete(NULL);
+    return;
+  }
+  bc_session_t *session = broadcaster_session_open();
+  if (!session) {
+    Serial.println("Too many stream clients");
+    close(sock);
+    s_running = false;
+    s_rtp_task = NULL;
+    vTaskDelete(NULL);
+    return;
+  }
+  s_ssrc = (uint32_t)esp_timer_get_time();
+  while (s_running) {
+    bc_frame_t *frame = broadcaster_session_next(session, pdMS_TO_TICKS(500));
+    if (!frame) {
+      continue;  // re-check s_running
+    }
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = s_dest_ip;
+    dest.sin_port = htons(s_dest_port);
+    send_frame_rtp(sock, &dest, frame->jpg_buf, frame->jpg_len);
+    broadcaster_frame_release(frame);
+    broadcaster_session_mark_sent(session);
+  }
+  broadcaster_session_close(session);
+  close(sock);
+  s_rtp_task = NULL;
+  vTaskDelete(NULL);
+}
+
+esp_err_t rtp_stream_start(uint32_t ip, uint16_t port) {
+  s_dest_ip = ip;
+  s_dest_port = port;
+  if (s_running) {
+    return ESP_OK;  // retargeted the existing sender
+  }
+  s_running = true;
+  if (xTaskCreatePinnedToCore(rtp_send_task, "rtp_send", 4096, NULL, 5,
+                              &s_rtp_task, 1) != pdPASS) {
+    s_running = false;
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+void rtp_stream_stop(void) {
+  s_running = false;  // task exits after its current wait
+}
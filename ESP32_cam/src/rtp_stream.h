@@ -0,0 +1,22 @@
+/*
+  RTP-over-UDP MJPEG transport (RFC 2435) for low-latency teleoperation.
+
+  TCP MJPEG suffers head-of-line blocking: one lost segment stalls every
+  later frame. Here each JPEG is packetized into RTP/UDP datagrams, so a
+  lost packet costs that one frame and the next frame arrives on time.
+  One destination at a time, aimed at the teleop viewer; started and
+  stopped via the /rtp control URI.
+*/
+#ifndef RTP_STREAM_H
+#define RTP_STREAM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Starts (or retargets) the RTP sender towards ip:port. ip is in network
+// byte order as delivered by the socket layer.
+esp_err_t rtp_stream_start(uint32_t ip, uint16_t port);
+
+void rtp_stream_stop(void);
+
+#endif // RTP_STREAM_H
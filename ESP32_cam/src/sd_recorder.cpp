@@ -0,0 +1,155 @@
+#include "sd_recorder.h"
+
+#include <string.h>
+#include "Arduino.h"
+#include "FS.h"
+#include "SD_MMC.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "stream_broadcaster.h"
+
+#define REC_BLOCK_SIZE   (32 * 1024)  // SD writes happen in these units
+#define REC_QUEUE_DEPTH  4
+#define REC_TASK_PRIO    2            // below capture, xmit and httpd
+
+static TaskHandle_t s_writer_task = NULL;
+static QueueHandle_t s_frame_queue = NULL;  // bc_frame_t*, refs held
+static esp_timer_handle_t s_tick_timer = NULL;
+static volatile bool s_recording = false;
+static bool s_mounted = false;
+
+// Staging block: frames accumulate here and go to the card one full
+// block at a time. The write is synchronous on the writer task, so one
+// buffer is enough. 512-aligned so the SD driver can DMA straight from it.
+static uint8_t *s_block = NULL;
+static size_t s_fill = 0;
+static File s_file;
+
+// Timer callback: cheap and non-blocking, just takes a reference on the
+// newest frame and hands it to the writer.
+static void recorder_tick(void *arg) {
+  if (!s_recording) {
+    return;
+  }
+  bc_frame_t *frame = broadcaster_latest_frame();
+  if (!frame) {
+    return;
+  }
+  if (xQueueSend(s_frame_queue, &frame, 0) != pdTRUE) {
+    broadcaster_frame_release(frame);  // card is behind, skip this frame
+  }
+}
+
+static void flush_block(void) {
+  if (s_fill == 0) {
+    return;
+  }
+  if (s_file.write(s_block, s_fill) != s_fill) {
+    Serial.println("SD write failed");
+  }
+  s_fill = 0;
+}
+
+// Appends the frame to the staging block, flushing full blocks as it
+// goes. Frames larger than a block are written in block-sized pieces.
+static void stage_frame(const bc_frame_t *frame) {
+  size_t off = 0;
+  while (off < frame->jpg_len) {
+    size_t room = REC_BLOCK_SIZE - s_fill;
+    size_t chunk = frame->jpg_len - off;
+    if (chunk > room) {
+      chunk = room;
+    }
+    memcpy(s_block + s_fill, frame->jpg_buf + off, chunk);
+    s_fill += chunk;
+    off += chunk;
+    if (s_fill == REC_BLOCK_SIZE) {
+      flush_block();
+    }
+  }
+}
+
+static void writer_task(void *arg) {
+  while (true) {
+    bc_frame_t *frame = NULL;
+    if (xQueueReceive(s_frame_queue, &frame, pdMS_TO_TICKS(500)) == pdTRUE) {
+      if (s_recording) {
+        stage_frame(frame);
+      }
+      broadcaster_frame_release(frame);
+    } else if (!s_recording && s_file) {
+      // Drained after stop: flush the partial block and close out.
+      flush_block();
+      s_file.close();
+    }
+  }
+}
+
+esp_err_t sd_recorder_start(uint32_t interval_ms) {
+  if (!s_mounted) {
+    if (!SD_MMC.begin("/sdcard", true)) {
+      Serial.println("SD card mount failed");
+      return ESP_FAIL;
+    }
+    s_mounted = true;
+  }
+  if (!s_block) {
+    s_block = (uint8_t *)heap_caps_aligned_alloc(
+        512, REC_BLOCK_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (!s_block) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  if (!s_frame_queue) {
+    s_frame_queue = xQueueCreate(REC_QUEUE_DEPTH, sizeof(bc_frame_t *));
+    if (!s_frame_queue) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  if (!s_writer_task) {
+    if (xTaskCreatePinnedToCore(writer_task, "sd_writer", 4096, NULL,
+                                REC_TASK_PRIO, &s_writer_task, 0) != pdPASS) {
+      return ESP_FAIL;
+    }
+  }
+  if (!s_tick_timer) {
+    const esp_timer_create_args_t args = {
+      .callback = recorder_tick,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "rec_tick"
+    };
+    if (esp_timer_create(&args, &s_tick_timer) != ESP_OK) {
+      return ESP_FAIL;
+    }
+  }
+  if (s_recording) {
+    esp_timer_stop(s_tick_timer);
+  }
+  if (!s_file) {
+    char path[32];
+    snprintf(path, sizeof(path), "/timelapse_%u.mjpeg",
+             (uint32_t)(esp_timer_get_time() / 1000000));
+    s_file = SD_MMC.open(path, FILE_WRITE);
+    if (!s_file) {
+      Serial.println("SD file open failed");
+      return ESP_FAIL;
+    }
+    Serial.printf("Recording to %s\n", path);
+  }
+  s_fill = 0;
+  s_recording = true;
+  return esp_timer_start_periodic(s_tick_timer, (uint64_t)interval_ms * 1000);
+}
+
+void sd_recorder_stop(void) {
+  if (!s_recording) {
+    return;
+  }
+  s_recording = false;
+  esp_timer_stop(s_tick_timer);
+  // The writer flushes and closes once the queue drains.
+}
@@ -0,0 +1,23 @@
+/*
+  Asynchronous SD-card time-lapse recorder.
+
+  A periodic timer grabs the broadcaster's latest frame at the recording
+  rate and queues it; a dedicated writer task drains the queue and
+  appends the JPEGs to an .mjpeg file on SD_MMC through two large
+  staging blocks, so card latency is absorbed off the streaming path and
+  recording never costs stream frames.
+*/
+#ifndef SD_RECORDER_H
+#define SD_RECORDER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Mounts the card (1-bit mode, keeps GPIO4 free) on first use and starts
+// recording one frame every interval_ms into a new file.
+esp_err_t sd_recorder_start(uint32_t interval_ms);
+
+// Flushes the partial staging block and closes the file.
+void sd_recorder_stop(void);
+
+#endif // SD_RECORDER_H
@@ -0,0 +1,522 @@
+#include "stream_broadcaster.h"
+#include "motion_gate.h"
+#include "ring_log.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include "Arduino.h"
+#include "esp_camera.h"
+#include "img_converters.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#define BC_MAX_SESSIONS   4
+#define BC_JPEG_QUALITY   80
+#define BC_IDLE_DELAY_MS  100
+
+// Capture runs on the PRO core, encode/transmit drains the ring from the
+// APP core next to httpd, so WiFi send latency never stalls the sensor.
+#define BC_CAPTURE_CORE   0
+#define BC_XMIT_CORE      1
+#define BC_FRAME_RING_DEPTH 2  // matches fb_count = 2 in PSRAM builds
+
+// Enough slots for every session to hold one frame in flight plus one
+// pending, one spare for the encoder, and one pinned as the snapshot.
+#define BC_FRAME_POOL_SIZE (BC_MAX_SESSIONS + 3)
+
+struct bc_session {
+  bool in_use;
+  bc_frame_t *pending;      // freshest unconsumed frame, guarded by s_lock
+  SemaphoreHandle_t ready;  // binary, given when pending is set
+  uint32_t frames_sent;
+  uint32_t frames_dropped;  // frames replaced before the client drained them
+};
+
+static bc_session_t s_sessions[BC_MAX_SESSIONS];
+static int s_session_count = 0;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_capture_task = NULL;
+static TaskHandle_t s_xmit_task = NULL;
+static QueueHandle_t s_frame_ring = NULL;  // camera_fb_t* slots, capture -> xmit
+
+// Conversion buffer pool. Each slot keeps its buffer for the lifetime of
+// the firmware; acquire/release only flips the busy flag, so streaming
+// causes zero heap traffic after broadcaster_start().
+static bc_frame_t s_frame_pool[BC_FRAME_POOL_SIZE];
+static size_t s_frame_buf_size = 0;
+
+// Adaptive quality controller state (see the section further down);
+// lives up here because broadcaster_start() seeds the ceiling.
+static uint32_t s_send_budget_us = 150000;  // glass-to-socket target
+static uint32_t s_send_ema_us = 0;
+static int64_t s_last_adjust_us = 0;
+static framesize_t s_max_frame_size = FRAMESIZE_QVGA;  // never upscale past setup()
+
+static bc_frame_t *frame_acquire(void) {
+  bc_frame_t *frame = NULL;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  for (int i = 0; i < BC_FRAME_POOL_SIZE; i++) {
+    if (!s_frame_pool[i].busy) {
+      frame = &s_frame_pool[i];
+      frame->busy = true;
+      frame->jpg_len = 0;
+      frame->refs = 0;
+      break;
+    }
+  }
+  xSemaphoreGive(s_lock);
+  return frame;
+}
+
+// Caller must hold s_lock.
+static void frame_release_locked(bc_frame_t *frame) {
+  if (--frame->refs <= 0) {
+    frame->busy = false;
+  }
+}
+
+void broadcaster_frame_release(bc_frame_t *frame) {
+  if (!frame) {
+    return;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  frame_release_locked(frame);
+  xSemaphoreGive(s_lock);
+}
+
+static bc_frame_t *s_last_frame = NULL;  // most recent broadcast, for /snapshot
+
+static void broadcast_frame(bc_frame_t *frame) {
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  frame->refs = 1;  // capture task's own reference while fanning out
+  if (s_last_frame) {
+    frame_release_locked(s_last_frame);
+  }
+  frame->refs++;
+  s_last_frame = frame;
+  for (int i = 0; i < BC_MAX_SESSIONS; i++) {
+    bc_session_t *session = &s_sessions[i];
+    if (!session->in_use) {
+      continue;
+    }
+    if (session->pending) {
+      // Client missed its deadline (the arrival of the next frame), so
+      // drop the stale image rather than queueing it up. This is the
+      // backpressure valve: slow clients lose frames, nobody blocks.
+      frame_release_locked(session->pending);
+      session->frames_dropped++;
+    }
+    frame->refs++;
+    session->pending = frame;
+    xSemaphoreGive(session->ready);
+  }
+  frame_release_locked(frame);
+  xSemaphoreGive(s_lock);
+}
+
+// Producer side of the pipeline: grabs frames and pushes them into the
+// ring. When the ring is full the oldest slot is recycled so capture
+// never waits on the transmit side.
+static void capture_task(void *arg) {
+  while (true) {
+    if (s_session_count == 0) {
+      // No streamers: tick along at ~1 fps so /snapshot stays warm.
+      vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    int64_t capture_start = esp_timer_get_time();
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (!fb) {
+      ring_log("Camera capture failed");
+      vTaskDelay(pdMS_TO_TICKS(BC_IDLE_DELAY_MS));
+      continue;
+    }
+    broadcaster_stage_record(BC_STAGE_CAPTURE,
+                             (uint32_t)(esp_timer_get_time() - capture_start));
+    if (xQueueSend(s_frame_ring, &fb, 0) != pdTRUE) {
+      camera_fb_t *stale = NULL;
+      if (xQueueReceive(s_frame_ring, &stale, 0) == pdTRUE) {
+        esp_camera_fb_return(stale);
+      }
+      if (xQueueSend(s_frame_ring, &fb, 0) != pdTRUE) {
+        esp_camera_fb_return(fb);
+      }
+    }
+  }
+}
+
+// --- Region-of-interest crop --------------------------------------------
+//
+// When a ROI is set, raw frames are compacted in place to the requested
+// rectangle before JPEG conversion, so we encode and transmit only the
+// pixels that matter. JPEG-format frames pass through untouched (the
+// compressed stream cannot be cropped without a decode).
+
+static volatile uint16_t s_roi_x = 0, s_roi_y = 0, s_roi_w = 0, s_roi_h = 0;
+
+void broadcaster_set_roi(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  s_roi_x = x & ~7;
+  s_roi_y = y & ~7;
+  s_roi_w = w & ~7;
+  s_roi_h = h & ~7;
+}
+
+static size_t bytes_per_pixel(pixformat_t format) {
+  switch (format) {
+    case PIXFORMAT_GRAYSCALE: return 1;
+    case PIXFORMAT_RGB565:
+    case PIXFORMAT_YUV422:    return 2;
+    default:                  return 0;
+  }
+}
+
+// Compacts the ROI rows to the front of the framebuffer and rewrites the
+// shadow descriptor's geometry. No allocation: crops are always smaller
+// than the source, so rows move backwards within the same buffer.
+static void apply_roi(camera_fb_t *fb) {
+  size_t bpp = bytes_per_pixel(fb->format);
+  if (bpp == 0 || s_roi_w == 0 || s_roi_h == 0) {
+    return;
+  }
+  uint16_t x = s_roi_x, y = s_roi_y, w = s_roi_w, h = s_roi_h;
+  if (x >= fb->width || y >= fb->height) {
+    return;
+  }
+  if (x + w > fb->width) {
+    w = (fb->width - x) & ~7;
+  }
+  if (y + h > fb->height) {
+    h = (fb->height - y) & ~7;
+  }
+  if (w == 0 || h == 0) {
+    return;
+  }
+  for (uint16_t row = 0; row < h; row++) {
+    memmove(fb->buf + (size_t)row * w * bpp,
+            fb->buf + ((size_t)(y + row) * fb->width + x) * bpp,
+            (size_t)w * bpp);
+  }
+  fb->width = w;
+  fb->height = h;
+  fb->len = (size_t)w * h * bpp;
+}
+
+// frame2jpg_cb sink writing straight into a pool buffer.
+static size_t pool_jpg_out(void *arg, size_t index, const void *data, size_t len) {
+  bc_frame_t *frame = (bc_frame_t *)arg;
+  if (index + len > s_frame_buf_size) {
+    return 0;  // encoder output would overflow the pool slot, abort
+  }
+  memcpy(frame->jpg_buf + index, (const uint8_t *)data, len);
+  frame->jpg_len = index + len;
+  return len;
+}
+
+// Consumer side: encodes (when needed) and fans frames out to sessions,
+// pinned to the httpd core so all network-bound work shares it.
+static void xmit_task(void *arg) {
+  while (true) {
+    camera_fb_t *fb = NULL;
+    if (xQueueReceive(s_frame_ring, &fb, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    if (!motion_gate_check(fb)) {
+      // Static scene inside the keepalive window: skip encode and send.
+      esp_camera_fb_return(fb);
+      continue;
+    }
+    bc_frame_t *frame = frame_acquire();
+    if (!frame) {
+      // Every pool slot is held by slow clients; skip this frame.
+      esp_camera_fb_return(fb);
+      continue;
+    }
+    bool ok;
+    int64_t convert_start = esp_timer_get_time();
+    if (fb->format != PIXFORMAT_JPEG) {
+      // Encode via a shadow descriptor so the ROI crop can rewrite the
+      // geometry without touching the driver's bookkeeping.
+      camera_fb_t shadow = *fb;
+      apply_roi(&shadow);
+      ok = frame2jpg_cb(&shadow, BC_JPEG_QUALITY, pool_jpg_out, frame);
+      if (!ok) {
+        ring_log("JPEG compression failed");
+      }
+    } else {
+      // Copy out so the driver buffer goes straight back to the sensor
+      // instead of being held hostage by slow clients.
+      ok = fb->len <= s_frame_buf_size;
+      if (ok) {
+        memcpy(frame->jpg_buf, fb->buf, fb->len);
+        frame->jpg_len = fb->len;
+      } else {
+        ring_log("Frame larger than pool buffer, dropped (%u bytes)", fb->len);
+      }
+    }
+    broadcaster_stage_record(BC_STAGE_CONVERT,
+                             (uint32_t)(esp_timer_get_time() - convert_start));
+    esp_camera_fb_return(fb);
+    if (ok) {
+      broadcast_frame(frame);
+    } else {
+      xSemaphoreTake(s_lock, portMAX_DELAY);
+      frame->busy = false;
+      xSemaphoreGive(s_lock);
+    }
+  }
+}
+
+esp_err_t broadcaster_start(framesize_t frame_size) {
+  if (s_capture_task) {
+    return ESP_OK;
+  }
+  s_lock = xSemaphoreCreateMutex();
+  if (!s_lock) {
+    return ESP_ERR_NO_MEM;
+  }
+  s_max_frame_size = frame_size;
+  if (motion_gate_init() != ESP_OK) {
+    Serial.println("Motion gate init failed, gating disabled");
+  }
+  // Worst-case JPEG output at our quality settings stays well under a
+  // third of the raw frame size; allocate once, from PSRAM when present.
+  s_frame_buf_size =
+      (resolution[frame_size].width * resolution[frame_size].height) / 3;
+  for (int i = 0; i < BC_FRAME_POOL_SIZE; i++) {
+    s_frame_pool[i].jpg_buf = (uint8_t *)heap_caps_malloc(
+        s_frame_buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_frame_pool[i].jpg_buf) {
+      s_frame_pool[i].jpg_buf = (uint8_t *)malloc(s_frame_buf_size);
+    }
+    if (!s_frame_pool[i].jpg_buf) {
+      return ESP_ERR_NO_MEM;
+    }
+    s_frame_pool[i].busy = false;
+  }
+  for (int i = 0; i < BC_MAX_SESSIONS; i++) {
+    s_sessions[i].ready = xSemaphoreCreateBinary();
+    if (!s_sessions[i].ready) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  s_frame_ring = xQueueCreate(BC_FRAME_RING_DEPTH, sizeof(camera_fb_t *));
+  if (!s_frame_ring) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (xTaskCreatePinnedToCore(capture_task, "cam_capture", 4096, NULL, 5,
+                              &s_capture_task, BC_CAPTURE_CORE) != pdPASS) {
+    return ESP_FAIL;
+  }
+  if (xTaskCreatePinnedToCore(xmit_task, "cam_xmit", 4096, NULL, 5,
+                              &s_xmit_task, BC_XMIT_CORE) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+bc_session_t *broadcaster_session_open(void) {
+  bc_session_t *session = NULL;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  for (int i = 0; i < BC_MAX_SESSIONS; i++) {
+    if (!s_sessions[i].in_use) {
+      session = &s_sessions[i];
+      session->in_use = true;
+      session->pending = NULL;
+      session->frames_sent = 0;
+      session->frames_dropped = 0;
+      xSemaphoreTake(session->ready, 0);  // clear any stale signal
+      s_session_count++;
+      break;
+    }
+  }
+  xSemaphoreGive(s_lock);
+  return session;
+}
+
+void broadcaster_session_close(bc_session_t *session) {
+  if (!session) {
+    return;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  if (session->pending) {
+    frame_release_locked(session->pending);
+    session->pending = NULL;
+  }
+  session->in_use = false;
+  s_session_count--;
+  xSemaphoreGive(s_lock);
+}
+
+bc_frame_t *broadcaster_session_next(bc_session_t *session, TickType_t timeout) {
+  if (xSemaphoreTake(session->ready, timeout) != pdTRUE) {
+    return NULL;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  bc_frame_t *frame = session->pending;
+  session->pending = NULL;
+  xSemaphoreGive(s_lock);
+  return frame;  // caller inherits the session's reference
+}
+
+void broadcaster_session_mark_sent(bc_session_t *session) {
+  session->frames_sent++;
+}
+
+// --- Pipeline timing instrumentation ------------------------------------
+//
+// Cheap enough to stay on in production: one esp_timer read per stage
+// boundary and a few integer ops per sample. Buckets are log2 of the
+// sample in microseconds, so bucket 10 is ~1 ms, bucket 17 is ~131 ms.
+
+#define BC_HIST_BUCKETS 20
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t hist[BC_HIST_BUCKETS];
+} bc_stage_stats_t;
+
+static bc_stage_stats_t s_stage_stats[BC_STAGE_COUNT];
+static const char *s_stage_names[BC_STAGE_COUNT] = {"capture", "convert", "send"};
+
+void broadcaster_stage_record(bc_stage_t stage, uint32_t us) {
+  bc_stage_stats_t *st = &s_stage_stats[stage];
+  if (st->count == 0 || us < st->min_us) {
+    st->min_us = us;
+  }
+  if (us > st->max_us) {
+    st->max_us = us;
+  }
+  st->count++;
+  st->total_us += us;
+  int bucket = 0;
+  for (uint32_t v = us; v > 1 && bucket < BC_HIST_BUCKETS - 1; v >>= 1) {
+    bucket++;
+  }
+  st->hist[bucket]++;
+}
+
+size_t broadcaster_timing_json(char *buf, size_t buf_len) {
+  size_t off = 0;
+  off += snprintf(buf + off, buf_len - off, "{");
+  for (int s = 0; s < BC_STAGE_COUNT; s++) {
+    bc_stage_stats_t *st = &s_stage_stats[s];
+    uint32_t avg = st->count ? (uint32_t)(st->total_us / st->count) : 0;
+    off += snprintf(buf + off, buf_len - off,
+                    "%s\"%s\":{\"count\":%u,\"min_us\":%u,\"max_us\":%u,"
+                    "\"avg_us\":%u,\"hist\":[",
+                    s ? "," : "", s_stage_names[s], st->count,
+                    st->count ? st->min_us : 0, st->max_us, avg);
+    for (int b = 0; b < BC_HIST_BUCKETS; b++) {
+      off += snprintf(buf + off, buf_len - off, "%s%u", b ? "," : "",
+                      st->hist[b]);
+    }
+    off += snprintf(buf + off, buf_len - off, "]}");
+  }
+  off += snprintf(buf + off, buf_len - off, "}");
+  return off;
+}
+
+// --- Adaptive quality control -------------------------------------------
+//
+// The send path reports how long each frame took to hand to the socket.
+// When the moving average blows the budget we first coarsen jpeg_quality
+// (cheap, reversible), then step the frame size down a rung; with ample
+// headroom we walk back up the same ladder. Adjustments are rate-limited
+// so the sensor is not reconfigured on every wobble.
+
+#define BC_ADAPT_PERIOD_US  2000000  // at most one adjustment per 2 s
+#define BC_QUALITY_BEST     10       // matches setup()'s PSRAM default
+#define BC_QUALITY_WORST    30
+#define BC_QUALITY_STEP     5
+
+void broadcaster_set_send_budget_ms(uint32_t budget_ms) {
+  s_send_budget_us = budget_ms * 1000;
+}
+
+static void adapt_stream_settings(void) {
+  int64_t now = esp_timer_get_time();
+  if (now - s_last_adjust_us < BC_ADAPT_PERIOD_US) {
+    return;
+  }
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) {
+    return;
+  }
+  if (s_send_ema_us > s_send_budget_us) {
+    if (s->status.quality < BC_QUALITY_WORST) {
+      s->set_quality(s, s->status.quality + BC_QUALITY_STEP);
+    } else if (s->status.framesize > FRAMESIZE_QVGA) {
+      s->set_framesize(s, (framesize_t)(s->status.framesize - 1));
+    }
+    s_last_adjust_us = now;
+  } else if (s_send_ema_us < s_send_budget_us / 2) {
+    if (s->status.framesize < s_max_frame_size) {
+      s->set_framesize(s, (framesize_t)(s->status.framesize + 1));
+    } else if (s->status.quality > BC_QUALITY_BEST) {
+      s->set_quality(s, s->status.quality - BC_QUALITY_STEP);
+    }
+    s_last_adjust_us = now;
+  }
+}
+
+void broadcaster_report_send_us(uint32_t send_us) {
+  broadcaster_stage_record(BC_STAGE_SEND, send_us);
+  // 1/8 EMA; lossy concurrent updates from several senders are fine here.
+  s_send_ema_us = s_send_ema_us - (s_send_ema_us >> 3) + (send_us >> 3);
+  adapt_stream_settings();
+}
+
+esp_err_t broadcaster_set_framesize(framesize_t frame_size) {
+  size_t needed =
+      ((size_t)resolution[frame_size].width * resolution[frame_size].height) / 3;
+  if (needed > s_frame_buf_size) {
+    return ESP_ERR_INVALID_SIZE;  // pool was sized at start, can't grow live
+  }
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (s->set_framesize(s, frame_size) != 0) {
+    return ESP_FAIL;
+  }
+  // The driver swaps framebuffers between captures, so the switch costs
+  // one frame. Anchor the adaptive controller to the new ceiling.
+  s_max_frame_size = frame_size;
+  return ESP_OK;
+}
+
+bc_frame_t *broadcaster_latest_frame(void) {
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  bc_frame_t *frame = s_last_frame;
+  if (frame) {
+    frame->refs++;  // caller's reference, dropped via broadcaster_frame_release
+  }
+  xSemaphoreGive(s_lock);
+  return frame;
+}
+
+size_t broadcaster_stats_json(char *buf, size_t buf_len) {
+  size_t off = 0;
+  off += snprintf(buf + off, buf_len - off, "[");
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  bool first = true;
+  for (int i = 0; i < BC_MAX_SESSIONS; i++) {
+    bc_session_t *session = &s_sessions[i];
+    if (!session->in_use) {
+      continue;
+    }
+    off += snprintf(buf + off, buf_len - off,
+                    "%s{\"session\":%d,\"sent\":%u,\"dropped\":%u}",
+                    first ? "" : ",", i,
+                    session->frames_sent, session->frames_dropped);
+    first = false;
+  }
+  xSemaphoreGive(s_lock);
+  off += snprintf(buf + off, buf_len - off, "]");
+  return off;
+}
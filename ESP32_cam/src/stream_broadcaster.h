@@ -0,0 +1,91 @@
+/*
+  Frame broadcaster for the MJPEG stream server.
+
+  A single capture task owns the camera and fans every captured frame out
+  to all registered stream sessions, so N viewers cost one capture and one
+  JPEG encode instead of N. Sessions always see the freshest frame: if a
+  client has not consumed its pending frame by the time the next one
+  arrives, the old frame is replaced.
+*/
+#ifndef STREAM_BROADCASTER_H
+#define STREAM_BROADCASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+
+// A reference-counted JPEG frame shared between stream sessions. Frames
+// and their buffers come from a fixed pool allocated once at start, so
+// the steady-state stream path does no heap allocation.
+typedef struct {
+  uint8_t *jpg_buf;
+  size_t jpg_len;
+  int refs;          // internal, guarded by the broadcaster lock
+  bool busy;         // internal, pool slot in use
+} bc_frame_t;
+
+typedef struct bc_session bc_session_t;
+
+// Starts the capture task and sizes the conversion buffer pool for the
+// configured sensor frame size. Called once from startCameraServer().
+esp_err_t broadcaster_start(framesize_t frame_size);
+
+// Registers a stream session. Returns NULL when all slots are taken.
+bc_session_t *broadcaster_session_open(void);
+void broadcaster_session_close(bc_session_t *session);
+
+// Blocks until a frame is available for this session (or the timeout
+// expires, returning NULL). The caller must release the frame when the
+// send is done.
+bc_frame_t *broadcaster_session_next(bc_session_t *session, TickType_t timeout);
+void broadcaster_frame_release(bc_frame_t *frame);
+
+// Returns the most recently broadcast frame with a reference held for
+// the caller (release with broadcaster_frame_release), or NULL when
+// nothing has been captured yet. Backs the /snapshot endpoint.
+bc_frame_t *broadcaster_latest_frame(void);
+
+// Bumps the session's sent counter once a frame went out on the wire.
+void broadcaster_session_mark_sent(bc_session_t *session);
+
+// Feeds one frame's measured socket send time into the adaptive quality
+// controller, which steps jpeg_quality / frame_size down when the send
+// budget is exceeded and back up when headroom returns.
+void broadcaster_report_send_us(uint32_t send_us);
+
+// Overrides the default 150 ms per-frame send budget.
+void broadcaster_set_send_budget_ms(uint32_t budget_ms);
+
+// Switches the sensor frame size live through the sensor API (no camera
+// reinit). Fails with ESP_ERR_INVALID_SIZE when the requested size would
+// overflow the conversion buffer pool allocated at start.
+esp_err_t broadcaster_set_framesize(framesize_t frame_size);
+
+// Restricts encoding to a rectangle of the sensor frame. Applied between
+// capture and JPEG conversion for raw pixel formats (coordinates are
+// clamped and aligned to 8); w = 0 clears the crop.
+void broadcaster_set_roi(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+// Writes a JSON array of the active sessions with their sent/dropped
+// frame counts into buf. Returns the number of bytes written.
+size_t broadcaster_stats_json(char *buf, size_t buf_len);
+
+// Pipeline stages tracked by the timing instrumentation.
+typedef enum {
+  BC_STAGE_CAPTURE,
+  BC_STAGE_CONVERT,
+  BC_STAGE_SEND,
+  BC_STAGE_COUNT
+} bc_stage_t;
+
+// Records one sample (microseconds) into the stage's running histogram.
+void broadcaster_stage_record(bc_stage_t stage, uint32_t us);
+
+// Writes per-stage counts, min/max/avg and log2 histograms as JSON.
+// Backs the /stats endpoint. Returns the number of bytes written.
+size_t broadcaster_timing_json(char *buf, size_t buf_len);
+
+#endif // STREAM_BROADCASTER_H
@@ -66,6 +66,50 @@ IPAddress ap_dns(8, 8, 4, 4);
 static const char *_STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
 static const char *_STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
 static const char *_STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+// Per-frame header cache: part headers are preformatted once per
+// Content-Length digit count so the stream loop only copies a template
+// and patches the digits, instead of snprintf + strlen per frame.
+#define STREAM_PART_PREFIX "Content-Type: image/jpeg\r\nContent-Length: "
+#define STREAM_PART_MAX_DIGITS 8
+
+static char _stream_part_cache[STREAM_PART_MAX_DIGITS + 1][64];
+static size_t _stream_part_cache_len[STREAM_PART_MAX_DIGITS + 1];
+static size_t _stream_boundary_len = 0;
+
+static void initStreamHeaderCache()
+{
+  _stream_boundary_len = strlen(_STREAM_BOUNDARY);
+  for (int d = 1; d <= STREAM_PART_MAX_DIGITS; d++)
+  {
+    char digits[STREAM_PART_MAX_DIGITS + 1];
+    memset(digits, '0', d);
+    digits[d] = '\0';
+    _stream_part_cache_len[d] = snprintf(_stream_part_cache[d], 64,
+                                         STREAM_PART_PREFIX "%s\r\n\r\n", digits);
+  }
+}
+
+static size_t buildStreamPartHeader(char *dst, size_t jpg_len)
+{
+  int digits = 1;
+  for (size_t v = jpg_len; v >= 10; v /= 10)
+    digits++;
+  if (digits > STREAM_PART_MAX_DIGITS)
+  {
+    return snprintf(dst, 64, _STREAM_PART, jpg_len); // Fallback for oversized frames
+  }
+  size_t hlen = _stream_part_cache_len[digits];
+  memcpy(dst, _stream_part_cache[digits], hlen);
+  char *p = dst + sizeof(STREAM_PART_PREFIX) - 1 + digits;
+  size_t v = jpg_len;
+  while (digits-- > 0)
+  {
+    *--p = '0' + (v % 10);
+    v /= 10;
+  }
+  return hlen;
+}
 // Handle for the HTTP stream server
 httpd_handle_t stream_httpd = NULL;
 // Function to handle HTTP requests for the video stream
@@ -128,8 +172,8 @@ static esp_err_t stream_handler(httpd_req_t *req)
     }
     if (res == ESP_OK)
     {
-      size_t hlen = snprintf((char *)part_buf, 64, _STREAM_PART, _jpg_buf_len); // Prepare HTTP header
-      res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);           // Send header chunk
+      size_t hlen = buildStreamPartHeader((char *)part_buf, _jpg_buf_len); // Prepare HTTP header from cache
+      res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);      // Send header chunk
     }
     if (res == ESP_OK)
     {
@@ -137,7 +181,7 @@ static esp_err_t stream_handler(httpd_req_t *req)
     }
     if (res == ESP_OK)
     {
-      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY)); // Send boundary marker
+      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, _stream_boundary_len); // Send boundary marker
     }
     if (fb)
     {
@@ -213,6 +257,7 @@ void onEvent(arduino_event_id_t event, arduino_event_info_t info)
 
 void startCameraServer()
 {
+  initStreamHeaderCache();
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 80;
 
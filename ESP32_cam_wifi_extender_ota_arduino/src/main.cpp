@@ -24,6 +24,8 @@
 #include "soc/rtc_cntl_reg.h"  //disable brownout problems
 #include "esp_http_server.h"
 #include <ArduinoOTA.h>  // **Add for OTA**
+#include "pull_ota.h"    // HTTP-pull resumable OTA
+#include "qos.h"         // repeater/stream budget arbitration
 
 //Replace with your network credentials
 
@@ -150,6 +152,20 @@ static esp_err_t stream_handler(httpd_req_t *req){
         }
       }
     }
+    if(res == ESP_OK && !qos_stream_frame_permit(_jpg_buf_len)){
+      // Over the stream's budget this second: drop the frame and leave
+      // the airtime to the repeater.
+      if(fb){
+        esp_camera_fb_return(fb);
+        fb = NULL;
+        _jpg_buf = NULL;
+      } else if(_jpg_buf){
+        free(_jpg_buf);
+        _jpg_buf = NULL;
+      }
+      delay(20);
+      continue;
+    }
     if(res == ESP_OK){
       size_t hlen = snprintf((char *)part_buf, 64, _STREAM_PART, _jpg_buf_len);
       res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
@@ -176,6 +192,43 @@ static esp_err_t stream_handler(httpd_req_t *req){
   return res;
 }
 
+// /ota?url=http://host/firmware.bin starts a background pull of the
+// image; progress survives link drops and reboots.
+static esp_err_t ota_handler(httpd_req_t *req){
+  char buf[300];
+  char url[256] = {0,};
+  if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) != ESP_OK ||
+      httpd_query_key_value(buf, "url", url, sizeof(url)) != ESP_OK) {
+    httpd_resp_send_404(req);
+    return ESP_FAIL;
+  }
+  if (pull_ota_begin(url) != ESP_OK) {
+    return httpd_resp_send_500(req);
+  }
+  return httpd_resp_send(req, "ota started", HTTPD_RESP_USE_STRLEN);
+}
+
+// /qos?fps=N&kbps=N retunes the stream budget; either may be omitted.
+// A bare GET returns the current config and window usage.
+static esp_err_t qos_handler(httpd_req_t *req){
+  char buf[64];
+  char val[8];
+  if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) == ESP_OK) {
+    uint32_t fps = 0, kbps = 0;
+    if (httpd_query_key_value(buf, "fps", val, sizeof(val)) == ESP_OK) {
+      fps = atoi(val);
+    }
+    if (httpd_query_key_value(buf, "kbps", val, sizeof(val)) == ESP_OK) {
+      kbps = atoi(val);
+    }
+    qos_set(fps, kbps);
+  }
+  char out[160];
+  size_t len = qos_stats_json(out, sizeof(out));
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_send(req, out, len);
+}
+
 void onEvent(arduino_event_id_t event, arduino_event_info_t info) {
   switch (event) {
     case ARDUINO_EVENT_WIFI_STA_START:     Serial.println("STA Started"); break;
@@ -216,6 +269,9 @@ void onEvent(arduino_event_id_t event, arduino_event_info_t info) {
 void startCameraServer(){
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 80;
+  // Keep the stream's server below the WiFi/lwIP forwarding tasks so
+  // NAPT always wins the CPU when both are runnable.
+  config.task_priority = 3;
 
   httpd_uri_t index_uri = {
     .uri       = "/",
@@ -224,9 +280,24 @@ void startCameraServer(){
     .user_ctx  = NULL
   };
   
+  httpd_uri_t qos_uri = {
+    .uri       = "/qos",
+    .method    = HTTP_GET,
+    .handler   = qos_handler,
+    .user_ctx  = NULL
+  };
+  httpd_uri_t ota_uri = {
+    .uri       = "/ota",
+    .method    = HTTP_GET,
+    .handler   = ota_handler,
+    .user_ctx  = NULL
+  };
+
   //Serial.printf("Starting web server on port: '%d'\n", config.server_port);
   if (httpd_start(&stream_httpd, &config) == ESP_OK) {
     httpd_register_uri_handler(stream_httpd, &index_uri);
+    httpd_register_uri_handler(stream_httpd, &ota_uri);
+    httpd_register_uri_handler(stream_httpd, &qos_uri);
   }
 }
 
@@ -298,6 +369,7 @@ void setup() {
   Serial.print(WiFi.localIP());
   
   // Start streaming web server
+  qos_init();
   startCameraServer();
 }
 
@@ -0,0 +1,157 @@
+#include "pull_ota.h"
+
+#include <string.h>
+#include "Arduino.h"
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define OTA_CHUNK_SIZE   (16 * 1024)
+#define OTA_TASK_PRIO    1          // below NAPT forwarding and streaming
+#define OTA_RETRY_MS     5000
+#define OTA_CHUNK_GAP_MS 50         // breathing room between chunks
+
+static TaskHandle_t s_ota_task = NULL;
+static char s_url[256];
+
+// One ranged GET; returns bytes written, 0 on a retryable failure, or -1
+// when the server reports the image complete below our offset.
+static int fetch_chunk(const esp_partition_t *part, uint32_t offset,
+                       uint8_t *buf, uint32_t *total_out) {
+  HTTPClient http;
+  if (!http.begin(s_url)) {
+    return 0;
+  }
+  char range[48];
+  snprintf(range, sizeof(range), "bytes=%u-%u", offset,
+           offset + OTA_CHUNK_SIZE - 1);
+  http.addHeader("Range", range);
+  const char *hdrs[] = {"Content-Range"};
+  http.collectHeaders(hdrs, 1);
+  int code = http.GET();
+  if (code != 206) {
+    Serial.printf("OTA chunk HTTP %d\n", code);
+    http.end();
+    return 0;
+  }
+  // "bytes start-end/total"
+  String cr = http.header("Content-Range");
+  int slash = cr.lastIndexOf('/');
+  if (slash >= 0) {
+    *total_out = (uint32_t)cr.substring(slash + 1).toInt();
+  }
+  if (*total_out && offset >= *total_out) {
+    http.end();
+    return -1;
+  }
+  WiFiClient *stream = http.getStreamPtr();
+  int want = http.getSize();
+  if (want <= 0 || want > OTA_CHUNK_SIZE) {
+    want = OTA_CHUNK_SIZE;
+  }
+  int got = 0;
+  uint32_t deadline = millis() + 10000;
+  while (got < want && millis() < deadline) {
+    int n = stream->read(buf + got, want - got);
+    if (n > 0) {
+      got += n;
+    } else {
+      delay(10);
+    }
+  }
+  http.end();
+  if (got == 0) {
+    return 0;
+  }
+  if (esp_partition_write(part, offset, buf, got) != ESP_OK) {
+    Serial.println("OTA flash write failed");
+    return 0;
+  }
+  return got;
+}
+
+static void pull_ota_task(void *arg) {
+  Preferences prefs;
+  prefs.begin("pullota", false);
+  const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+  if (!part) {
+    Serial.println("OTA: no inactive partition");
+    goto out;
+  }
+  {
+    uint32_t offset = 0;
+    uint32_t total = prefs.getUInt("total", 0);
+    if (prefs.getString("url", "") == s_url) {
+      offset = prefs.getUInt("off", 0);
+      Serial.printf("OTA resuming at %u\n", offset);
+    } else {
+      // New transfer: erase once, then record what we're pulling so a
+      // reboot mid-download can resume instead of re-erasing.
+      if (esp_partition_erase_range(part, 0, part->size) != ESP_OK) {
+        Serial.println("OTA erase failed");
+        goto out;
+      }
+      prefs.putString("url", s_url);
+      prefs.putUInt("off", 0);
+      prefs.putUInt("total", 0);
+      total = 0;
+    }
+    uint8_t *buf = (uint8_t *)malloc(OTA_CHUNK_SIZE);
+    if (!buf) {
+      goto out;
+    }
+    while (true) {
+      if (WiFi.status() != WL_CONNECTED) {
+        vTaskDelay(pdMS_TO_TICKS(OTA_RETRY_MS));
+        continue;
+      }
+      int n = fetch_chunk(part, offset, buf, &total);
+      if (n > 0) {
+        offset += n;
+        prefs.putUInt("off", offset);
+        if (total) {
+          prefs.putUInt("total", total);
+        }
+        if (total && offset >= total) {
+          break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(OTA_CHUNK_GAP_MS));
+      } else if (n < 0) {
+        break;  // already past the end, finalize
+      } else {
+        vTaskDelay(pdMS_TO_TICKS(OTA_RETRY_MS));
+      }
+    }
+    free(buf);
+    Serial.printf("OTA download complete (%u bytes), validating\n", offset);
+    prefs.remove("url");
+    prefs.remove("off");
+    prefs.remove("total");
+    if (esp_ota_set_boot_partition(part) == ESP_OK) {
+      Serial.println("OTA image valid, rebooting");
+      delay(100);
+      esp_restart();
+    } else {
+      Serial.println("OTA image failed validation");
+    }
+  }
+out:
+  prefs.end();
+  s_ota_task = NULL;
+  vTaskDelete(NULL);
+}
+
+esp_err_t pull_ota_begin(const char *url) {
+  if (s_ota_task) {
+    return ESP_ERR_INVALID_STATE;  // one transfer at a time
+  }
+  strlcpy(s_url, url, sizeof(s_url));
+  if (xTaskCreate(pull_ota_task, "pull_ota", 8192, NULL, OTA_TASK_PRIO,
+                  &s_ota_task) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,22 @@
+/*
+  HTTP-pull OTA with ranged, resumable chunk downloads.
+
+  ArduinoOTA pushes the whole image in one connection, which takes the
+  repeater out of service for minutes on slow links and restarts from
+  zero when the transfer dies. This mode pulls the image itself: small
+  ranged GETs are written straight to the inactive partition from a task
+  prioritized below the forwarding path, the confirmed offset is
+  persisted to NVS, and a dropped link (or a reboot) resumes where it
+  left off instead of starting over.
+*/
+#ifndef PULL_OTA_H
+#define PULL_OTA_H
+
+#include "esp_err.h"
+
+// Starts (or resumes, when the URL matches the persisted transfer) a
+// background pull of the firmware image at url. Reboots into the new
+// image when the download completes and validates.
+esp_err_t pull_ota_begin(const char *url);
+
+#endif // PULL_OTA_H
@@ -0,0 +1,58 @@
+#include "qos.h"
+
+#include <stdio.h>
+#include "esp_timer.h"
+
+// Defaults leave roughly 10 Mbps of a typical 2.4 GHz repeater link to
+// forwarding: the stream gets at most 15 frames and 500 KB per second.
+#define QOS_DEFAULT_MAX_FPS   15
+#define QOS_DEFAULT_MAX_KBPS  4000
+
+static uint32_t s_max_fps = QOS_DEFAULT_MAX_FPS;
+static uint32_t s_max_bytes = QOS_DEFAULT_MAX_KBPS * 1000 / 8;
+
+// One-second accounting window. Single writer per field in practice;
+// approximate accounting is fine for a rate cap.
+static int64_t s_window_start_us = 0;
+static uint32_t s_window_frames = 0;
+static uint32_t s_window_bytes = 0;
+static uint32_t s_denied_frames = 0;
+
+void qos_init(void) {
+  s_window_start_us = esp_timer_get_time();
+}
+
+bool qos_stream_frame_permit(size_t frame_bytes) {
+  int64_t now = esp_timer_get_time();
+  if (now - s_window_start_us >= 1000000) {
+    s_window_start_us = now;
+    s_window_frames = 0;
+    s_window_bytes = 0;
+  }
+  if (s_window_frames >= s_max_fps ||
+      s_window_bytes + frame_bytes > s_max_bytes) {
+    s_denied_frames++;
+    return false;
+  }
+  s_window_frames++;
+  s_window_bytes += frame_bytes;
+  return true;
+}
+
+void qos_set(uint32_t max_fps, uint32_t max_kbps) {
+  if (max_fps) {
+    s_max_fps = max_fps;
+  }
+  if (max_kbps) {
+    s_max_bytes = max_kbps * 1000 / 8;
+  }
+}
+
+size_t qos_stats_json(char *buf, size_t buf_len) {
+  return snprintf(buf, buf_len,
+                  "{\"max_fps\":%u,\"max_kbps\":%u,"
+                  "\"window_frames\":%u,\"window_bytes\":%u,"
+                  "\"denied_frames\":%u}",
+                  s_max_fps, s_max_bytes * 8 / 1000, s_window_frames,
+                  s_window_bytes, s_denied_frames);
+}
@@ -0,0 +1,32 @@
+/*
+  CPU/airtime arbitration between the NAPT repeater and the camera
+  stream.
+
+  Forwarding runs in the WiFi and lwIP tasks at high priority; the
+  stream runs under httpd. Left alone, a fast viewer eats the radio and
+  forwarding throughput collapses. This module gives the stream an
+  explicit budget — frames per second and bytes per second — so the
+  repeater keeps its floor and the camera consumes only the slack. Both
+  knobs are runtime-configurable via /qos.
+*/
+#ifndef QOS_H
+#define QOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+void qos_init(void);
+
+// Asks permission to send one stream frame of the given size. Returns
+// false when the current one-second window is out of frame or byte
+// budget; the caller should skip (not queue) the frame.
+bool qos_stream_frame_permit(size_t frame_bytes);
+
+// max_fps = 0 or max_kbps = 0 leaves that limit unchanged.
+void qos_set(uint32_t max_fps, uint32_t max_kbps);
+
+// Current config and window usage as JSON; returns bytes written.
+size_t qos_stats_json(char *buf, size_t buf_len);
+
+#endif // QOS_H
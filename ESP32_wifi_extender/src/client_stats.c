@@ -0,0 +1,217 @@
+/* Per-client traffic accounting
+
+   connect_count only tells us how many stations are associated; when
+   throughput drops we want to know which one is responsible. This module
+   interposes on the AP netif's input and linkoutput functions and charges
+   every frame to the station MAC in its ethernet header.
+
+   The counters sit on the forwarding path, so each entry keeps one
+   accumulator set per core and the hot path only ever touches the slot
+   for the core it runs on — no locks, no cross-core cache bouncing. The
+   JSON dump sums both slots.
+
+   The same interposition points carry an optional per-station token
+   bucket (see client_stats_set_limit). Frames over budget are dropped
+   rather than queued: TCP backs off within a round trip, so one greedy
+   station can no longer occupy the whole air interface, and nothing new
+   is ever allocated on the forwarding path. Each direction's bucket is
+   only touched from the path that already runs it (input from the wifi
+   task, linkoutput from the lwIP task), keeping the single-writer rule.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_netif_net_stack.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/prot/ethernet.h"
+
+#include "client_stats.h"
+
+static const char *TAG = "client_stats";
+
+#define CS_MAX_CLIENTS 16
+
+struct cs_entry {
+    uint8_t mac[6];
+    uint8_t used;
+    /* Indexed by core id; summed only when reporting. */
+    uint32_t rx_bytes[2];
+    uint32_t rx_pkts[2];
+    uint32_t tx_bytes[2];
+    uint32_t tx_pkts[2];
+    /* Token buckets, one per direction so each has a single writer. */
+    int32_t rx_tokens;
+    uint32_t rx_refill_ms;
+    int32_t tx_tokens;
+    uint32_t tx_refill_ms;
+    uint32_t rx_drops;
+    uint32_t tx_drops;
+};
+
+static struct cs_entry cs_tab[CS_MAX_CLIENTS];
+
+/* 0 = no limit. Shared read-only by the hot paths; written only from
+ * the console. Bucket depth is one burst interval's worth of bytes. */
+#define CS_BURST_MS 250
+static volatile uint32_t cs_limit_kbps = 0;
+
+void client_stats_set_limit(uint32_t kbps)
+{
+    cs_limit_kbps = kbps;
+}
+
+uint32_t client_stats_get_limit(void)
+{
+    return cs_limit_kbps;
+}
+
+/* Refill the bucket for the time that passed and try to take len
+ * bytes from it. Returns 0 when the frame should be dropped. */
+static int cs_take(int32_t *tokens, uint32_t *refill_ms, uint32_t len)
+{
+    uint32_t kbps = cs_limit_kbps;
+    if (kbps == 0) {
+        return 1;
+    }
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t elapsed = now - *refill_ms;
+    if (elapsed > 0) {
+        int32_t cap = (int32_t)(kbps * CS_BURST_MS / 8);
+        *tokens += (int32_t)(elapsed * kbps / 8);
+        if (*tokens > cap) {
+            *tokens = cap;
+        }
+        *refill_ms = now;
+    }
+    if (*tokens < (int32_t)len) {
+        return 0;
+    }
+    *tokens -= (int32_t)len;
+    return 1;
+}
+
+static netif_input_fn cs_orig_input = NULL;
+static netif_linkoutput_fn cs_orig_linkoutput = NULL;
+
+extern esp_netif_t* wifiAP;
+
+static struct cs_entry *cs_lookup(const uint8_t *mac)
+{
+    int free_slot = -1;
+    for (int i = 0; i < CS_MAX_CLIENTS; i++) {
+        if (cs_tab[i].used) {
+            if (memcmp(cs_tab[i].mac, mac, 6) == 0) {
+                return &cs_tab[i];
+            }
+        } else if (free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    if (free_slot < 0) {
+        return NULL;
+    }
+    /* Claiming a slot races in theory, but frames for a new station
+     * arrive on one core first; worst case a frame goes uncounted. */
+    memcpy(cs_tab[free_slot].mac, mac, 6);
+    cs_tab[free_slot].used = 1;
+    return &cs_tab[free_slot];
+}
+
+/* Frames from a station: charge the source MAC. */
+static err_t cs_input(struct pbuf *p, struct netif *inp)
+{
+    if (p->len >= sizeof(struct eth_hdr)) {
+        const struct eth_hdr *eth = (const struct eth_hdr *)p->payload;
+        struct cs_entry *e = cs_lookup((const uint8_t *)&eth->src);
+        if (e != NULL) {
+            if (!cs_take(&e->rx_tokens, &e->rx_refill_ms, p->tot_len)) {
+                e->rx_drops++;
+                pbuf_free(p);
+                return ERR_OK;
+            }
+            int core = xPortGetCoreID();
+            e->rx_bytes[core] += p->tot_len;
+            e->rx_pkts[core]++;
+        }
+    }
+    return cs_orig_input(p, inp);
+}
+
+/* Frames to a station: charge the destination MAC. Broadcast and
+ * multicast are nobody's traffic in particular, so they are skipped. */
+static err_t cs_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    if (p->len >= sizeof(struct eth_hdr)) {
+        const struct eth_hdr *eth = (const struct eth_hdr *)p->payload;
+        const uint8_t *dst = (const uint8_t *)&eth->dest;
+        if ((dst[0] & 0x01) == 0) {
+            struct cs_entry *e = cs_lookup(dst);
+            if (e != NULL) {
+                if (!cs_take(&e->tx_tokens, &e->tx_refill_ms, p->tot_len)) {
+                    /* Caller still owns the pbuf; just don't send it. */
+                    e->tx_drops++;
+                    return ERR_OK;
+                }
+                int core = xPortGetCoreID();
+                e->tx_bytes[core] += p->tot_len;
+                e->tx_pkts[core]++;
+            }
+        }
+    }
+    return cs_orig_linkoutput(netif, p);
+}
+
+void client_stats_init(void)
+{
+    struct netif *netif = esp_netif_get_netif_impl(wifiAP);
+    if (netif == NULL) {
+        ESP_LOGE(TAG, "AP netif not up, accounting disabled");
+        return;
+    }
+    cs_orig_input = netif->input;
+    cs_orig_linkoutput = netif->linkoutput;
+    netif->input = cs_input;
+    netif->linkoutput = cs_linkoutput;
+    ESP_LOGI(TAG, "Per-client accounting enabled on AP netif");
+}
+
+int client_stats_json(char *buf, size_t len)
+{
+    int n = 0;
+    n += snprintf(buf + n, len - n, "[");
+    for (int i = 0; i < CS_MAX_CLIENTS && n < len; i++) {
+        struct cs_entry *e = &cs_tab[i];
+        if (!e->used) {
+            continue;
+        }
+        n += snprintf(buf + n, len - n,
+            "%s{\"mac\":\"%02x:%02x:%02x:%02x:%02x:%02x\","
+            "\"rx_bytes\":%lu,\"rx_pkts\":%lu,"
+            "\"tx_bytes\":%lu,\"tx_pkts\":%lu,"
+            "\"rx_drops\":%lu,\"tx_drops\":%lu}",
+            (n > 1) ? "," : "",
+            e->mac[0], e->mac[1], e->mac[2], e->mac[3], e->mac[4], e->mac[5],
+            (unsigned long)(e->rx_bytes[0] + e->rx_bytes[1]),
+            (unsigned long)(e->rx_pkts[0] + e->rx_pkts[1]),
+            (unsigned long)(e->tx_bytes[0] + e->tx_bytes[1]),
+            (unsigned long)(e->tx_pkts[0] + e->tx_pkts[1]),
+            (unsigned long)e->rx_drops, (unsigned long)e->tx_drops);
+    }
+    if (n < len) {
+        n += snprintf(buf + n, len - n, "]");
+    }
+    return n;
+}
@@ -0,0 +1,34 @@
+/* Per-client traffic accounting for the stations behind the AP.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Worst case ~110 bytes per entry; sized for a full table. */
+#define CS_STATS_BUF_LEN 2048
+
+/* Hooks the AP netif's input/output paths to count per-station bytes
+ * and packets. Call once after wifi_init(). */
+void client_stats_init(void);
+
+/* Writes the accounting table as a JSON array into buf; returns the
+ * number of bytes written (excluding the terminator). */
+int client_stats_json(char *buf, size_t len);
+
+/* Per-station rate limit in kbit/s, applied as a token bucket in each
+ * direction on the forwarding path; 0 disables limiting. Takes effect
+ * immediately, persisted separately ("sta_kbps" in NVS). */
+void client_stats_set_limit(uint32_t kbps);
+uint32_t client_stats_get_limit(void);
+
+#ifdef __cplusplus
+}
+#endif
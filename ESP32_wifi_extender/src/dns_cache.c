@@ -0,0 +1,263 @@
+/* Caching DNS forwarder
+
+   Every query from a client behind the AP used to travel the backhaul to
+   the upstream resolver, adding a full uplink round trip to every
+   connection setup. This forwarder answers repeat queries from a small
+   in-RAM cache honoring TTLs and only forwards misses upstream. The DHCP
+   server hands out the AP address as resolver so clients talk to us.
+
+   Runs on lwIP's raw UDP API, so both directions are handled in the
+   tcpip thread with no extra task or socket copies.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_system.h"
+
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
+#include "lwip/ip_addr.h"
+
+#include "dns_cache.h"
+
+static const char *TAG = "dns_cache";
+
+#define DNS_PORT           53
+#define DNS_MAX_PKT        512   /* classic UDP DNS limit */
+#define DNS_CACHE_ENTRIES  32
+#define DNS_PENDING_MAX    16
+#define DNS_PENDING_TO_MS  3000
+#define DNS_MIN_TTL_S      30    /* clamp silly low TTLs */
+#define DNS_MAX_TTL_S      3600  /* and CDN-style huge ones */
+
+struct dns_cache_entry {
+    uint32_t qhash;      /* hash over question section, 0 = empty */
+    uint32_t expires_ms;
+    uint16_t resp_len;
+    uint8_t *resp;       /* full response packet, txid rewritten per hit */
+};
+
+struct dns_pending {
+    uint8_t in_use;
+    uint16_t txid;        /* client's transaction id (also sent upstream) */
+    uint32_t qhash;
+    uint32_t born_ms;
+    ip_addr_t client_addr;
+    uint16_t client_port;
+};
+
+static struct dns_cache_entry s_cache[DNS_CACHE_ENTRIES];
+static struct dns_pending s_pending[DNS_PENDING_MAX];
+static struct udp_pcb *s_pcb = NULL;
+static ip_addr_t s_upstream;
+
+static uint32_t s_hits = 0;
+static uint32_t s_misses = 0;
+
+/* FNV-1a over the question section, lowercasing label bytes so the
+ * 0x20-randomized queries some clients send still hit the cache. */
+static uint32_t dns_question_hash(const uint8_t *pkt, uint16_t len)
+{
+    uint32_t h = 2166136261u;
+    /* Skip the 12-byte header; hash to the end of the first question
+     * (qname is a label sequence terminated by a zero byte, then 4
+     * bytes of qtype/qclass). */
+    uint16_t i = 12;
+    while (i < len && pkt[i] != 0) {
+        i += pkt[i] + 1;
+    }
+    i += 5; /* zero byte + qtype + qclass */
+    if (i > len) {
+        return 0;
+    }
+    for (uint16_t j = 12; j < i; j++) {
+        uint8_t c = pkt[j];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        h = (h ^ c) * 16777619u;
+    }
+    return h ? h : 1;
+}
+
+/* Walks the answer records and returns the smallest TTL, clamped. */
+static uint32_t dns_min_ttl(const uint8_t *pkt, uint16_t len)
+{
+    uint16_t ancount = (pkt[6] << 8) | pkt[7];
+    uint32_t ttl = DNS_MAX_TTL_S;
+
+    /* Skip the question. */
+    uint16_t i = 12;
+    while (i < len && pkt[i] != 0) {
+        i += pkt[i] + 1;
+    }
+    i += 5;
+
+    while (ancount-- > 0 && i + 10 < len) {
+        /* Name: either a compression pointer or a label sequence. */
+        if ((pkt[i] & 0xC0) == 0xC0) {
+            i += 2;
+        } else {
+            while (i < len && pkt[i] != 0) {
+                i += pkt[i] + 1;
+            }
+            i += 1;
+        }
+        if (i + 10 > len) {
+            break;
+        }
+        uint32_t rttl = ((uint32_t)pkt[i + 4] << 24) | ((uint32_t)pkt[i + 5] << 16)
+                      | ((uint32_t)pkt[i + 6] << 8) | pkt[i + 7];
+        if (rttl < ttl) {
+            ttl = rttl;
+        }
+        uint16_t rdlen = (pkt[i + 8] << 8) | pkt[i + 9];
+        i += 10 + rdlen;
+    }
+
+    if (ttl < DNS_MIN_TTL_S) {
+        ttl = DNS_MIN_TTL_S;
+    }
+    return ttl;
+}
+
+static struct dns_cache_entry *dns_cache_find(uint32_t qhash, uint32_t now)
+{
+    struct dns_cache_entry *e = &s_cache[qhash % DNS_CACHE_ENTRIES];
+    if (e->qhash == qhash && e->resp != NULL && (int32_t)(e->expires_ms - now) > 0) {
+        return e;
+    }
+    return NULL;
+}
+
+static void dns_cache_store(uint32_t qhash, const uint8_t *pkt, uint16_t len, uint32_t now)
+{
+    struct dns_cache_entry *e = &s_cache[qhash % DNS_CACHE_ENTRIES];
+    /* Direct-mapped: a colliding name just replaces the old entry. */
+    if (e->resp == NULL || e->resp_len < len) {
+        free(e->resp);
+        e->resp = malloc(len);
+        if (e->resp == NULL) {
+            e->qhash = 0;
+            return;
+        }
+    }
+    memcpy(e->resp, pkt, len);
+    e->resp_len = len;
+    e->qhash = qhash;
+    e->expires_ms = now + dns_min_ttl(pkt, len) * 1000;
+}
+
+static void dns_send_to(const uint8_t *pkt, uint16_t len, const ip_addr_t *addr, uint16_t port)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+    if (p == NULL) {
+        return;
+    }
+    pbuf_take(p, pkt, len);
+    udp_sendto(s_pcb, p, addr, port);
+    pbuf_free(p);
+}
+
+static void dns_recv_cb(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                        const ip_addr_t *addr, u16_t port)
+{
+    uint8_t pkt[DNS_MAX_PKT];
+
+    if (p->tot_len < 12 || p->tot_len > DNS_MAX_PKT) {
+        pbuf_free(p);
+        return;
+    }
+    uint16_t len = pbuf_copy_partial(p, pkt, sizeof(pkt), 0);
+    pbuf_free(p);
+
+    uint16_t txid = (pkt[0] << 8) | pkt[1];
+    uint32_t now = sys_now();
+
+    if ((pkt[2] & 0x80) == 0) {
+        /* Query from a client. */
+        uint32_t qhash = dns_question_hash(pkt, len);
+        if (qhash == 0) {
+            return;
+        }
+
+        struct dns_cache_entry *e = dns_cache_find(qhash, now);
+        if (e != NULL) {
+            s_hits++;
+            /* Rewrite the cached response's txid to the client's. */
+            e->resp[0] = pkt[0];
+            e->resp[1] = pkt[1];
+            dns_send_to(e->resp, e->resp_len, addr, port);
+            return;
+        }
+
+        s_misses++;
+        struct dns_pending *slot = NULL;
+        for (int i = 0; i < DNS_PENDING_MAX; i++) {
+            if (!s_pending[i].in_use
+                    || (uint32_t)(now - s_pending[i].born_ms) > DNS_PENDING_TO_MS) {
+                slot = &s_pending[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            return; /* table full; client will retry */
+        }
+        slot->in_use = 1;
+        slot->txid = txid;
+        slot->qhash = qhash;
+        slot->born_ms = now;
+        slot->client_addr = *addr;
+        slot->client_port = port;
+
+        dns_send_to(pkt, len, &s_upstream, DNS_PORT);
+    } else {
+        /* Response from upstream: match on txid, cache and relay. */
+        for (int i = 0; i < DNS_PENDING_MAX; i++) {
+            struct dns_pending *q = &s_pending[i];
+            if (q->in_use && q->txid == txid) {
+                uint8_t rcode = pkt[3] & 0x0F;
+                if (rcode == 0) {
+                    dns_cache_store(q->qhash, pkt, len, now);
+                }
+                dns_send_to(pkt, len, &q->client_addr, q->client_port);
+                q->in_use = 0;
+                return;
+            }
+        }
+        /* Late or unsolicited; drop. */
+    }
+}
+
+void dns_cache_set_upstream(uint32_t upstream)
+{
+    ip_addr_set_ip4_u32(&s_upstream, upstream);
+    ESP_LOGI(TAG, "upstream resolver set to %s", ipaddr_ntoa(&s_upstream));
+}
+
+void dns_cache_init(uint32_t upstream)
+{
+    ip_addr_set_ip4_u32(&s_upstream, upstream);
+
+    s_pcb = udp_new();
+    if (s_pcb == NULL) {
+        ESP_LOGE(TAG, "no pcb, DNS forwarder disabled");
+        return;
+    }
+    if (udp_bind(s_pcb, IP_ADDR_ANY, DNS_PORT) != ERR_OK) {
+        ESP_LOGE(TAG, "bind to port %d failed, DNS forwarder disabled", DNS_PORT);
+        udp_remove(s_pcb);
+        s_pcb = NULL;
+        return;
+    }
+    udp_recv(s_pcb, dns_recv_cb, NULL);
+    ESP_LOGI(TAG, "caching forwarder on port %d, %d entries", DNS_PORT, DNS_CACHE_ENTRIES);
+}
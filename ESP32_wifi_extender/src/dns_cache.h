@@ -0,0 +1,25 @@
+/* Caching DNS forwarder for clients behind the AP.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Binds the forwarder to UDP port 53 and starts answering queries.
+ * upstream is the resolver misses are forwarded to (network order). */
+void dns_cache_init(uint32_t upstream);
+
+/* Switches the upstream resolver, e.g. to the one the STA interface
+ * learned via DHCP. */
+void dns_cache_set_upstream(uint32_t upstream);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,10 +21,15 @@
 #include <esp_http_server.h>
 
 #include "pages.h"
+#include "pages_gz.h"
 #include "router_globals.h"
+#include "client_stats.h"
 
 static const char *TAG = "HTTPServer";
 
+/* Set in main.cpp from the "svc_core" NVS param. */
+extern int svc_core;
+
 esp_timer_handle_t restart_timer;
 
 static void restart_timer_callback(void* arg)
@@ -40,6 +45,66 @@ esp_timer_create_args_t restart_timer_args = {
         .name = "restart_timer"
 };
 
+/* Escapes html attribute characters into a caller-provided buffer;
+ * truncates rather than overflows. */
+static void html_escape_buf(const char* src, char* dst, size_t dst_len)
+{
+    size_t j = 0;
+    for (size_t i = 0; src[i] != '\0'; i++) {
+        if (src[i] == '\\' || src[i] == '\'' || src[i] == '\"' || src[i] == '&' || src[i] == '#' || src[i] == ';') {
+            if (j + 5 >= dst_len) {
+                break;
+            }
+            dst[j++] = '&';
+            dst[j++] = '#';
+            dst[j++] = '0' + (src[i] / 10);
+            dst[j++] = '0' + (src[i] % 10);
+            dst[j++] = ';';
+        }
+        else {
+            if (j + 1 >= dst_len) {
+                break;
+            }
+            dst[j++] = src[i];
+        }
+    }
+    dst[j] = '\0';
+}
+
+/* Streams the settings page straight from the flash-resident template,
+ * chunking out each literal run and substituting the %s fields from a
+ * stack buffer. No heap allocation per request, and no multi-KB copy of
+ * the page parked in RAM between views. */
+static esp_err_t send_config_page(httpd_req_t *req)
+{
+    const char* values[] = {
+        ap_ssid, ap_passwd,
+        ssid, passwd, ent_username, ent_identity,
+        static_ip, subnet_mask, gateway_addr
+    };
+    /* Params are <=64 chars; escaping expands 5x worst case. */
+    char esc[5 * 64 + 1];
+    const char* pos = CONFIG_PAGE;
+    int field = 0;
+
+    while (true) {
+        const char* hole = strstr(pos, "%s");
+        if (hole == NULL || field >= (int)(sizeof(values) / sizeof(values[0]))) {
+            break;
+        }
+        if (hole > pos) {
+            httpd_resp_send_chunk(req, pos, hole - pos);
+        }
+        html_escape_buf(values[field++], esc, sizeof(esc));
+        httpd_resp_send_chunk(req, esc, strlen(esc));
+        pos = hole + 2;
+    }
+    if (*pos != '\0') {
+        httpd_resp_send_chunk(req, pos, strlen(pos));
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 /* An HTTP GET handler */
 static esp_err_t index_get_handler(httpd_req_t *req)
 {
@@ -148,97 +213,238 @@ static esp_err_t index_get_handler(httpd_req_t *req)
         free(buf);
     }
 
-    /* Send response with custom headers and body set as the
-     * string passed in user context*/
-    const char* resp_str = (const char*) req->user_ctx;
-    httpd_resp_send(req, resp_str, strlen(resp_str));
+    /* Serve the precompressed static page when the client can take it;
+     * it fetches its field values from /config.json. Chunk-streaming the
+     * uncompressed template stays as the fallback. */
+    char enc[64];
+    if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", enc, sizeof(enc)) == ESP_OK
+            && strstr(enc, "gzip") != NULL) {
+        httpd_resp_set_type(req, "text/html");
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        return httpd_resp_send(req, (const char *)config_page_gz, config_page_gz_len);
+    }
+    return send_config_page(req);
+}
 
-    return ESP_OK;
+/* Appends one "key":"value" pair, escaping for JSON. */
+static int json_kv(char *buf, size_t len, const char *key, const char *val, bool first)
+{
+    int n = snprintf(buf, len, "%s\"%s\":\"", first ? "" : ",", key);
+    for (size_t i = 0; val[i] != '\0' && n + 3 < (int)len; i++) {
+        if (val[i] == '\"' || val[i] == '\\') {
+            buf[n++] = '\\';
+        }
+        buf[n++] = val[i];
+    }
+    if (n + 1 < (int)len) {
+        buf[n++] = '\"';
+    }
+    buf[n] = '\0';
+    return n;
 }
 
-static httpd_uri_t indexp = {
-    .uri       = "/",
+/* Current config values, keyed by the form input names so the page
+ * script can fill the fields directly. */
+static esp_err_t config_json_get_handler(httpd_req_t *req)
+{
+    char buf[768];
+    int n = 0;
+
+    n += snprintf(buf + n, sizeof(buf) - n, "{");
+    n += json_kv(buf + n, sizeof(buf) - n, "ap_ssid", ap_ssid, true);
+    n += json_kv(buf + n, sizeof(buf) - n, "ap_password", ap_passwd, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "ssid", ssid, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "password", passwd, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "ent_username", ent_username, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "ent_identity", ent_identity, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "staticip", static_ip, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "subnetmask", subnet_mask, false);
+    n += json_kv(buf + n, sizeof(buf) - n, "gateway", gateway_addr, false);
+    if (n < (int)sizeof(buf) - 1) {
+        n += snprintf(buf + n, sizeof(buf) - n, "}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, n);
+}
+
+static httpd_uri_t configjson = {
+    .uri       = "/config.json",
     .method    = HTTP_GET,
-    .handler   = index_get_handler,
+    .handler   = config_json_get_handler,
 };
 
-esp_err_t http_404_error_handler(httpd_req_t *req, httpd_err_code_t err)
+/* REST surface for the provisioning fleet: GET returns the same JSON as
+ * /config.json, POST accepts a flat {"key":"value"} delta of the form
+ * field names and stores them under the NVS params the console commands
+ * use. Changes apply on the next boot; include "reboot":"1" to restart
+ * after storing. */
+
+static const struct {
+    const char *json_key; /* form input / JSON name */
+    const char *nvs_key;  /* PARAM_NAMESPACE entry */
+} api_params[] = {
+    { "ap_ssid",      "ap_ssid" },
+    { "ap_password",  "ap_passwd" },
+    { "ssid",         "ssid" },
+    { "password",     "passwd" },
+    { "ent_username", "ent_username" },
+    { "ent_identity", "ent_identity" },
+    { "staticip",     "static_ip" },
+    { "subnetmask",   "subnet_mask" },
+    { "gateway",      "gateway_addr" },
+};
+
+/* Pulls the next "key":"value" pair out of a flat JSON object. Returns
+ * a pointer past the parsed pair, or NULL when no pair is left. Only
+ * \\\" and \\\\ escapes are handled; that covers SSIDs and passwords. */
+static const char *json_next_pair(const char *p, char *key, size_t key_len,
+                                  char *val, size_t val_len)
 {
-    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Page not found");
-    return ESP_FAIL;
+    for (int field = 0; field < 2; field++) {
+        char *out = field == 0 ? key : val;
+        size_t out_len = field == 0 ? key_len : val_len;
+        size_t n = 0;
+
+        p = strchr(p, '\"');
+        if (p == NULL) {
+            return NULL;
+        }
+        p++;
+        while (*p != '\0' && *p != '\"') {
+            char c = *p++;
+            if (c == '\\' && (*p == '\"' || *p == '\\')) {
+                c = *p++;
+            }
+            if (n + 1 < out_len) {
+                out[n++] = c;
+            }
+        }
+        if (*p != '\"') {
+            return NULL;
+        }
+        p++;
+        out[n] = '\0';
+    }
+    return p;
 }
 
-char* html_escape(const char* src) {
-    //Primitive html attribue escape, should handle most common issues.
-    int len = strlen(src);
-    //Every char in the string + a null
-    int esc_len = len + 1;
+static esp_err_t api_config_post_handler(httpd_req_t *req)
+{
+    char body[512];
+    char key[32];
+    char val[64];
+    bool reboot = false;
+    int stored = 0;
 
-    for (int i = 0; i < len; i++) {
-        if (src[i] == '\\' || src[i] == '\'' || src[i] == '\"' || src[i] == '&' || src[i] == '#' || src[i] == ';') {
-            //Will be replaced with a 5 char sequence
-            esc_len += 4;
-        }
+    if (req->content_len >= sizeof(body)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Body too large");
+        return ESP_FAIL;
     }
+    int received = httpd_req_recv(req, body, req->content_len);
+    if (received <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No body");
+        return ESP_FAIL;
+    }
+    body[received] = '\0';
 
-    char* res = malloc(sizeof(char) * esc_len);
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "NVS open failed");
+        return ESP_FAIL;
+    }
 
-    int j = 0;
-    for (int i = 0; i < len; i++) {
-        if (src[i] == '\\' || src[i] == '\'' || src[i] == '\"' || src[i] == '&' || src[i] == '#' || src[i] == ';') {
-            res[j++] = '&';
-            res[j++] = '#';
-            res[j++] = '0' + (src[i] / 10);
-            res[j++] = '0' + (src[i] % 10);
-            res[j++] = ';';
+    const char *p = body;
+    while ((p = json_next_pair(p, key, sizeof(key), val, sizeof(val))) != NULL) {
+        if (strcmp(key, "reboot") == 0) {
+            reboot = strcmp(val, "1") == 0;
+            continue;
         }
-        else {
-            res[j++] = src[i];
+        for (int i = 0; i < (int)(sizeof(api_params) / sizeof(api_params[0])); i++) {
+            if (strcmp(key, api_params[i].json_key) == 0) {
+                if (nvs_set_str(nvs, api_params[i].nvs_key, val) == ESP_OK) {
+                    stored++;
+                }
+                break;
+            }
         }
     }
-    res[j] = '\0';
 
-    return res;
+    if (stored > 0) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "NVS commit failed");
+        return ESP_FAIL;
+    }
+
+    char resp[64];
+    int n = snprintf(resp, sizeof(resp), "{\"stored\":%d,\"reboot\":%s}",
+        stored, reboot ? "true" : "false");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, n);
+
+    if (reboot) {
+        esp_timer_start_once(restart_timer, 500000);
+    }
+    return ESP_OK;
+}
+
+static httpd_uri_t api_config_get = {
+    .uri       = "/api/v1/config",
+    .method    = HTTP_GET,
+    .handler   = config_json_get_handler,
+};
+
+static httpd_uri_t api_config_post = {
+    .uri       = "/api/v1/config",
+    .method    = HTTP_POST,
+    .handler   = api_config_post_handler,
+};
+
+static httpd_uri_t indexp = {
+    .uri       = "/",
+    .method    = HTTP_GET,
+    .handler   = index_get_handler,
+};
+
+/* Per-client byte/packet counters as JSON; scraped by the fleet poller,
+ * so the shape should stay stable. */
+static esp_err_t stats_get_handler(httpd_req_t *req)
+{
+    char* buf = malloc(CS_STATS_BUF_LEN);
+    if (buf == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    int len = client_stats_json(buf, CS_STATS_BUF_LEN);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, buf, len);
+    free(buf);
+    return ESP_OK;
+}
+
+static httpd_uri_t statsp = {
+    .uri       = "/stats",
+    .method    = HTTP_GET,
+    .handler   = stats_get_handler,
+};
+
+esp_err_t http_404_error_handler(httpd_req_t *req, httpd_err_code_t err)
+{
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Page not found");
+    return ESP_FAIL;
 }
 
 httpd_handle_t start_webserver(void)
 {
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-
-    const char* config_page_template = CONFIG_PAGE;
-
-    char* safe_ap_ssid = html_escape(ap_ssid);
-    char* safe_ap_passwd = html_escape(ap_passwd);
-    char* safe_ssid = html_escape(ssid);
-    char* safe_passwd = html_escape(passwd);
-    char* safe_ent_username = html_escape(ent_username);
-    char* safe_ent_identity = html_escape(ent_identity);
-
-    int page_len =
-        strlen(config_page_template) +
-        strlen(safe_ap_ssid) +
-        strlen(safe_ap_passwd) +
-        strlen(safe_ssid) +
-        strlen(safe_passwd) +
-        strlen(safe_ent_username) +
-        strlen(safe_ent_identity) +
-        256;
-    char* config_page = malloc(sizeof(char) * page_len);
-
-    snprintf(
-        config_page, page_len, config_page_template,
-        safe_ap_ssid, safe_ap_passwd,
-        safe_ssid, safe_passwd, safe_ent_username, safe_ent_identity,
-            static_ip, subnet_mask, gateway_addr);
-    indexp.user_ctx = config_page;
-
-    free(safe_ap_ssid);
-    free(safe_ap_passwd);
-    free(safe_ssid);
-    free(safe_passwd);
-    free(safe_ent_username);
-    free(safe_ent_identity);
+    /* Keep the web server off the forwarding core; a config page view
+     * should never cost packet throughput. */
+    config.core_id = svc_core;
 
     esp_timer_create(&restart_timer_args, &restart_timer);
 
@@ -248,6 +454,10 @@ httpd_handle_t start_webserver(void)
         // Set URI handlers
         ESP_LOGI(TAG, "Registering URI handlers");
         httpd_register_uri_handler(server, &indexp);
+        httpd_register_uri_handler(server, &configjson);
+        httpd_register_uri_handler(server, &api_config_get);
+        httpd_register_uri_handler(server, &api_config_post);
+        httpd_register_uri_handler(server, &statsp);
         return server;
     }
 
@@ -35,6 +35,8 @@
 #include "dhcpserver/dhcpserver_options.h"
 
 #include "cmd_decl.h"
+#include "client_stats.h"
+#include "dns_cache.h"
 #include <esp_http_server.h>
 
 #if !IP_NAPT
@@ -66,6 +68,12 @@ uint16_t connect_count = 0;
 bool ap_connect = false;
 bool has_static_ip = false;
 
+/* Core the service tasks (httpd, console) run on. Wifi/lwip processing
+ * stays on core 0 (sdkconfig defaults), so with svc_core = 1 the config
+ * page and console can't steal cycles from packet forwarding. Stored as
+ * "svc_core" in NVS, settable with the task_core command. */
+int svc_core = 1;
+
 uint32_t my_ip;
 uint32_t my_ap_ip;
 
@@ -78,6 +86,20 @@ struct portmap_table_entry {
 };
 struct portmap_table_entry portmap_tab[IP_PORTMAP_MAX];
 
+/* Returns the index of the entry matching (proto, mport), or -1. This
+ * shadow table is only touched from config paths (add/del/load); the
+ * per-packet matching happens inside lwIP's own ip_portmap_table, so a
+ * straight scan of the 32 entries is plenty here. */
+int portmap_find(u8_t proto, u16_t mport) {
+    for (int i = 0; i < IP_PORTMAP_MAX; i++) {
+        struct portmap_table_entry *e = &portmap_tab[i];
+        if (e->valid && e->proto == proto && e->mport == mport) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 esp_netif_t* wifiAP;
 esp_netif_t* wifiSTA;
 
@@ -179,6 +201,15 @@ esp_err_t add_portmap(u8_t proto, u16_t mport, u32_t daddr, u16_t dport) {
     esp_err_t err;
     nvs_handle_t nvs;
 
+    if (portmap_find(proto, mport) >= 0) {
+        /* A forward for this (proto, mport) already exists. The old code
+         * inserted a duplicate row that shadowed the live one; reject it
+         * and say so, since scripted adds hit this silently otherwise. */
+        ESP_LOGW(TAG, "Portmap for %s port %d already exists, delete it first.",
+            proto == PROTO_TCP ? "TCP" : "UDP", mport);
+        return ESP_ERR_INVALID_STATE;
+    }
+
     for (int i = 0; i<IP_PORTMAP_MAX; i++) {
         if (!portmap_tab[i].valid) {
             portmap_tab[i].proto = proto;
@@ -212,27 +243,27 @@ esp_err_t del_portmap(u8_t proto, u16_t mport) {
     esp_err_t err;
     nvs_handle_t nvs;
 
-    for (int i = 0; i<IP_PORTMAP_MAX; i++) {
-        if (portmap_tab[i].valid && portmap_tab[i].mport == mport && portmap_tab[i].proto == proto) {
-            portmap_tab[i].valid = 0;
+    int i = portmap_find(proto, mport);
+    if (i < 0) {
+        return ESP_OK;
+    }
 
-            err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
-            if (err != ESP_OK) {
-                return err;
-            }
-            err = nvs_set_blob(nvs, "portmap_tab", portmap_tab, sizeof(portmap_tab));
-            if (err == ESP_OK) {
-                err = nvs_commit(nvs);
-                if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "New portmap table stored.");
-                }
-            }
-            nvs_close(nvs);
+    portmap_tab[i].valid = 0;
 
-            ip_portmap_remove(proto, mport);
-            return ESP_OK;
+    err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(nvs, "portmap_tab", portmap_tab, sizeof(portmap_tab));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "New portmap table stored.");
         }
     }
+    nvs_close(nvs);
+
+    ip_portmap_remove(proto, mport);
     return ESP_OK;
 }
 
@@ -373,8 +404,10 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         apply_portmap_tab();
         if (esp_netif_get_dns_info(wifiSTA, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK)
         {
-            esp_netif_set_dns_info(wifiAP, ESP_NETIF_DNS_MAIN, &dns);
-            ESP_LOGI(TAG, "set dns to:" IPSTR, IP2STR(&(dns.ip.u_addr.ip4)));
+            /* Clients keep resolving through our caching forwarder; only
+             * its upstream follows what the uplink handed out. */
+            dns_cache_set_upstream(dns.ip.u_addr.ip4.addr);
+            ESP_LOGI(TAG, "set upstream dns to:" IPSTR, IP2STR(&(dns.ip.u_addr.ip4)));
         }
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
     }
@@ -503,8 +536,9 @@ void wifi_init(const uint8_t* mac, const char* ssid, const char* ent_username, c
     dhcps_offer_t dhcps_dns_value = OFFER_DNS;
     esp_netif_dhcps_option(wifiAP,ESP_NETIF_OP_SET, ESP_NETIF_DOMAIN_NAME_SERVER, &dhcps_dns_value, sizeof(dhcps_dns_value));
 
-    // // Set custom dns server address for dhcp server
-    dnsserver.ip.u_addr.ip4.addr = esp_ip4addr_aton(DEFAULT_DNS);
+    // Hand out our own address as resolver so clients hit the caching
+    // forwarder instead of crossing the backhaul for every lookup
+    dnsserver.ip.u_addr.ip4.addr = my_ap_ip;
     dnsserver.ip.type = ESP_IPADDR_TYPE_V4;
     esp_netif_set_dns_info(wifiAP, ESP_NETIF_DNS_MAIN, &dnsserver);
 
@@ -542,6 +576,128 @@ char* param_set_default(const char* def_val) {
     return retval;
 }
 
+static void console_task(void *arg);
+
+/** Arguments used by 'task_core' function */
+static struct {
+    struct arg_int *core;
+    struct arg_end *end;
+} task_core_arg;
+
+/* 'task_core' command: choose which core httpd and the console run on */
+static int task_core(int argc, char **argv)
+{
+    esp_err_t err;
+    nvs_handle_t nvs;
+
+    int nerrors = arg_parse(argc, argv, (void **) &task_core_arg);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, task_core_arg.end, argv[0]);
+        return 1;
+    }
+
+    int core = task_core_arg.core->ival[0];
+    if (core != 0 && core != 1) {
+        printf("Core must be 0 or 1\n");
+        return 1;
+    }
+
+    err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_i32(nvs, "svc_core", core);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Service tasks will run on core %d after restart.", core);
+        }
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+static void register_task_core(void)
+{
+    task_core_arg.core = arg_int1(NULL, NULL, "<core>", "core for httpd and console (0 or 1)");
+    task_core_arg.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "task_core",
+        .help = "Set which core the httpd and console tasks run on (wifi/lwip stay on core 0)",
+        .hint = NULL,
+        .func = &task_core,
+        .argtable = &task_core_arg
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'ratelimit' function */
+static struct {
+    struct arg_int *kbps;
+    struct arg_end *end;
+} ratelimit_arg;
+
+/* 'ratelimit' command: per-station rate cap on the AP side */
+static int ratelimit(int argc, char **argv)
+{
+    esp_err_t err;
+    nvs_handle_t nvs;
+
+    int nerrors = arg_parse(argc, argv, (void **) &ratelimit_arg);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, ratelimit_arg.end, argv[0]);
+        return 1;
+    }
+
+    if (ratelimit_arg.kbps->count == 0) {
+        uint32_t kbps = client_stats_get_limit();
+        if (kbps == 0) {
+            printf("Per-station rate limit disabled\n");
+        } else {
+            printf("Per-station rate limit: %lu kbit/s each direction\n",
+                (unsigned long)kbps);
+        }
+        return 0;
+    }
+
+    int kbps = ratelimit_arg.kbps->ival[0];
+    if (kbps < 0) {
+        printf("Rate must be >= 0 (0 disables limiting)\n");
+        return 1;
+    }
+
+    err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_i32(nvs, "sta_kbps", kbps);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+        if (err == ESP_OK) {
+            client_stats_set_limit(kbps);
+            ESP_LOGI(TAG, "Per-station rate limit set to %d kbit/s.", kbps);
+        }
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+static void register_ratelimit(void)
+{
+    ratelimit_arg.kbps = arg_int0(NULL, NULL, "<kbps>", "per-station limit in kbit/s, 0 disables");
+    ratelimit_arg.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "ratelimit",
+        .help = "Show or set the per-station rate cap enforced on the AP forwarding path",
+        .hint = NULL,
+        .func = &ratelimit,
+        .argtable = &ratelimit_arg
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
 void app_main(void)
 {
     initialize_nvs();
@@ -596,11 +752,25 @@ void app_main(void)
         ap_ip = param_set_default(DEFAULT_AP_IP);
     }
 
+    int core = svc_core;
+    if (get_config_param_int("svc_core", &core) == ESP_OK && (core == 0 || core == 1)) {
+        svc_core = core;
+    }
+
     get_portmap_tab();
 
     // Setup WIFI
     wifi_init(mac, ssid, ent_username, ent_identity, passwd, static_ip, subnet_mask, gateway_addr, ap_mac, ap_ssid, ap_passwd, ap_ip);
 
+    client_stats_init();
+
+    int sta_kbps = 0;
+    if (get_config_param_int("sta_kbps", &sta_kbps) == ESP_OK && sta_kbps > 0) {
+        client_stats_set_limit(sta_kbps);
+    }
+
+    dns_cache_init(esp_ip4addr_aton(DEFAULT_DNS));
+
     pthread_t t1;
     pthread_create(&t1, NULL, led_status_thread, NULL);
 
@@ -625,7 +795,16 @@ void app_main(void)
     register_system();
     register_nvs();
     register_router();
+    register_task_core();
+    register_ratelimit();
 
+    /* The REPL runs pinned to the service core so a blocking linenoise
+     * read or a long command never sits on the forwarding core. */
+    xTaskCreatePinnedToCore(console_task, "console", 4096, NULL, 2, NULL, svc_core);
+}
+
+static void console_task(void *arg)
+{
     /* Prompt to be printed before each line.
      * This can be customized, made dynamic, etc.
      */
@@ -0,0 +1,137 @@
+/* Gzipped static settings page, generated from CONFIG_PAGE in pages.h.
+
+   The dynamic field values are gone from the markup; a small script in
+   the page fills the inputs from GET /config.json instead, so the whole
+   page body can be compressed once at build time and served verbatim
+   with Content-Encoding: gzip.
+
+   Regenerate after editing pages.h: take CONFIG_PAGE, replace each
+   value='%s' with value='', append the /config.json loader script, then
+   gzip -9 and dump the bytes here.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#pragma once
+
+static const unsigned char config_page_gz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0x57,
+    0x5b, 0x6f, 0xda, 0x48, 0x14, 0x7e, 0xef, 0xaf, 0x38, 0x4d, 0x1e, 0x0c,
+    0x12, 0x36, 0x97, 0xa6, 0x9b, 0x16, 0x0c, 0x52, 0x9a, 0xd0, 0xb4, 0xda,
+    0xb4, 0x1b, 0x95, 0xac, 0xfa, 0x50, 0x55, 0xd5, 0x60, 0x1f, 0xe3, 0x59,
+    0xc6, 0x33, 0xd6, 0xcc, 0x18, 0xc2, 0x46, 0xf9, 0xef, 0x7b, 0xc6, 0x36,
+    0x90, 0x66, 0x69, 0x4a, 0xab, 0xad, 0xb4, 0x0f, 0x11, 0x02, 0xec, 0xf1,
+    0xb9, 0x7c, 0xf3, 0x9d, 0xdb, 0x38, 0x4c, 0x6d, 0x26, 0x46, 0x61, 0x8a,
+    0x2c, 0x1e, 0x85, 0xed, 0xea, 0x2f, 0x43, 0xcb, 0x40, 0xb2, 0x0c, 0x87,
+    0xde, 0x82, 0xe3, 0x32, 0x57, 0xda, 0x7a, 0x10, 0x29, 0x69, 0x51, 0xda,
+    0xa1, 0xb7, 0xe4, 0xb1, 0x4d, 0x87, 0x31, 0x2e, 0x78, 0x84, 0x7e, 0x79,
+    0xd3, 0x02, 0x2e, 0xb9, 0xe5, 0x4c, 0xf8, 0x26, 0x62, 0x02, 0x87, 0x5d,
+    0x6f, 0x14, 0x1a, 0xbb, 0x12, 0x38, 0x9a, 0xaa, 0x78, 0x05, 0x37, 0x09,
+    0xa9, 0xfa, 0x09, 0xcb, 0xb8, 0x58, 0xf5, 0x81, 0xe5, 0xa8, 0xa3, 0xc2,
+    0xcf, 0xb5, 0x6a, 0x81, 0xcf, 0xf2, 0x5c, 0xa0, 0x6f, 0x56, 0xc6, 0x62,
+    0xd6, 0x82, 0xea, 0xdf, 0x2f, 0x78, 0x0b, 0x5e, 0x09, 0x2e, 0xe7, 0xef,
+    0x58, 0x34, 0x29, 0x97, 0x5e, 0x93, 0x81, 0x16, 0x78, 0x6f, 0x50, 0x2c,
+    0xd0, 0xf2, 0x88, 0xc1, 0x7b, 0x2c, 0xd0, 0x23, 0x05, 0x26, 0x8d, 0x6f,
+    0x50, 0xf3, 0x64, 0x90, 0xb3, 0x38, 0xe6, 0x72, 0xd6, 0x87, 0x2e, 0x66,
+    0x03, 0x52, 0x46, 0x3f, 0x45, 0x3e, 0x4b, 0x6d, 0x1f, 0x7a, 0xb4, 0x50,
+    0x22, 0x58, 0xd6, 0x0b, 0xdd, 0x4e, 0x67, 0x70, 0x6b, 0xe3, 0x1a, 0xd7,
+    0xdd, 0xd5, 0x8c, 0xcb, 0xad, 0xda, 0x51, 0x7e, 0xed, 0xc4, 0xfa, 0x09,
+    0xd7, 0xc6, 0xfa, 0x51, 0xca, 0x05, 0xa9, 0x80, 0xc5, 0x6b, 0xeb, 0x33,
+    0xc1, 0x67, 0xb2, 0x0f, 0xda, 0x49, 0x96, 0x4a, 0x25, 0x0d, 0xa5, 0x0d,
+    0x52, 0xaa, 0xa1, 0xf8, 0x7a, 0x6d, 0xd8, 0x19, 0x4a, 0xbb, 0xb5, 0x3f,
+    0xc3, 0xff, 0x46, 0x5a, 0x0c, 0x9e, 0xdf, 0x87, 0xd5, 0x73, 0xb0, 0xd2,
+    0xde, 0x3d, 0xb1, 0xde, 0x2e, 0xb1, 0x8c, 0xe9, 0x19, 0x79, 0x15, 0x98,
+    0xd0, 0xc2, 0x73, 0x67, 0x9e, 0xcb, 0xbc, 0xb0, 0x70, 0x33, 0x55, 0x3a,
+    0x46, 0x4d, 0x7a, 0xf9, 0x35, 0x18, 0x25, 0x78, 0x0c, 0x7a, 0x36, 0x6d,
+    0x74, 0x5f, 0xfe, 0xd6, 0x82, 0xf5, 0x4f, 0x73, 0x10, 0x29, 0xa1, 0x48,
+    0xc6, 0x3d, 0x39, 0xa6, 0xb5, 0xea, 0xdb, 0x1c, 0xd4, 0x7b, 0xe8, 0x1d,
+    0x39, 0xbc, 0x95, 0x21, 0x5f, 0xb3, 0x98, 0x17, 0xa6, 0x0f, 0xcf, 0x68,
+    0x69, 0x4d, 0x4c, 0xf9, 0xbc, 0x42, 0x50, 0x3e, 0x80, 0x3b, 0x7b, 0xee,
+    0xbb, 0x1b, 0xe8, 0x1e, 0x6d, 0x20, 0xf5, 0x13, 0x15, 0x15, 0x66, 0x03,
+    0x6c, 0x8b, 0x6b, 0x2a, 0x58, 0x34, 0x1f, 0xa8, 0xc2, 0xba, 0x58, 0xf5,
+    0x41, 0x2a, 0x89, 0xf0, 0x94, 0x67, 0x2e, 0xd7, 0x98, 0xb4, 0xe4, 0xff,
+    0xda, 0x37, 0x29, 0x8b, 0xd5, 0x92, 0x4c, 0xd2, 0xc7, 0x91, 0x08, 0x87,
+    0xc7, 0xdd, 0x97, 0xe3, 0xd3, 0xf1, 0xe0, 0xf6, 0x90, 0x92, 0x31, 0xe1,
+    0x33, 0xb8, 0xa9, 0x30, 0x1f, 0x95, 0xb4, 0x43, 0x8d, 0xa9, 0x03, 0xac,
+    0xb0, 0x6a, 0x70, 0x1b, 0xa8, 0xb9, 0x3f, 0x2d, 0xac, 0x55, 0x92, 0xdc,
+    0x93, 0xb3, 0x99, 0x56, 0x85, 0x8c, 0xfd, 0x7a, 0xf7, 0x87, 0x9d, 0xce,
+    0xf1, 0x0b, 0x3c, 0x5e, 0x93, 0x71, 0x98, 0x24, 0x09, 0xa9, 0x68, 0x8c,
+    0x1f, 0xd2, 0xc1, 0xe3, 0x1e, 0x12, 0xfd, 0x5f, 0xe9, 0x84, 0xed, 0x2a,
+    0xd5, 0x43, 0x97, 0xeb, 0xa3, 0x30, 0xe6, 0x0b, 0xe0, 0xf1, 0xd0, 0xab,
+    0x10, 0x52, 0x21, 0xa4, 0xdd, 0xd1, 0x78, 0x72, 0xf9, 0xac, 0x07, 0xef,
+    0x4f, 0xae, 0xe0, 0x03, 0x6d, 0x18, 0x35, 0x9c, 0x96, 0x0f, 0xa9, 0xdc,
+    0xba, 0x54, 0x28, 0x91, 0xe6, 0xb9, 0x1d, 0xf1, 0x04, 0x1a, 0x4b, 0x2e,
+    0x69, 0xc3, 0x81, 0x50, 0x11, 0xb3, 0x5c, 0xc9, 0xc0, 0x20, 0xd3, 0x51,
+    0x1a, 0x98, 0x62, 0x6a, 0xac, 0x6e, 0x74, 0x9b, 0xf0, 0x74, 0x08, 0x9e,
+    0xd7, 0xbc, 0x89, 0x89, 0xd3, 0x8c, 0x6a, 0x31, 0x98, 0xa1, 0x1d, 0x0b,
+    0x74, 0x97, 0xaf, 0x56, 0x6f, 0xe3, 0xc6, 0xda, 0x69, 0x33, 0x88, 0xb9,
+    0xc9, 0x05, 0x5b, 0x01, 0xc9, 0x3b, 0x66, 0xbd, 0xc1, 0x46, 0xc5, 0xa1,
+    0x0c, 0xb8, 0x94, 0xa8, 0xdf, 0x5c, 0xbd, 0xbb, 0x80, 0xa1, 0xf7, 0x3d,
+    0x80, 0x57, 0x29, 0x82, 0xc4, 0x25, 0x18, 0xb4, 0x96, 0x22, 0x6c, 0x20,
+    0x65, 0x0b, 0x84, 0x29, 0xa2, 0xa4, 0x25, 0x69, 0xc1, 0x2a, 0xb0, 0x24,
+    0x52, 0xf5, 0x83, 0x20, 0x9c, 0xea, 0x76, 0xa9, 0x92, 0xb3, 0x19, 0xc2,
+    0x92, 0x0b, 0x01, 0x1a, 0x13, 0x8d, 0x26, 0xa5, 0xb8, 0x13, 0xab, 0x2e,
+    0x34, 0x19, 0x73, 0x35, 0x2c, 0xc4, 0x2a, 0x08, 0x02, 0x6f, 0x40, 0x76,
+    0xaf, 0x78, 0x86, 0xe4, 0xb7, 0x71, 0xb0, 0xd9, 0x79, 0x4a, 0x4a, 0x0e,
+    0x7c, 0xdb, 0x3b, 0x68, 0x51, 0x51, 0x75, 0x3a, 0xcd, 0x92, 0xe8, 0x8a,
+    0xaa, 0x30, 0xed, 0x8d, 0x4e, 0x2e, 0x61, 0xb2, 0x06, 0xd4, 0xb0, 0x35,
+    0x44, 0x89, 0x76, 0xa9, 0xf4, 0xbc, 0x49, 0xb8, 0x7b, 0xa3, 0x30, 0x51,
+    0x3a, 0x03, 0x16, 0x39, 0x7b, 0x43, 0xcf, 0x03, 0x6a, 0x6a, 0xa9, 0xa2,
+    0xc0, 0x9c, 0x8f, 0xaf, 0x28, 0x2a, 0x96, 0x4d, 0x5d, 0xcc, 0xac, 0xa6,
+    0x6f, 0x3c, 0x9a, 0x4c, 0xde, 0x9e, 0x85, 0x6d, 0xba, 0x70, 0x37, 0x61,
+    0x55, 0x4b, 0x76, 0x95, 0x53, 0xff, 0x73, 0xe5, 0xee, 0xd5, 0xbd, 0x90,
+    0xe5, 0x5f, 0x8c, 0xe1, 0xb1, 0x07, 0x0b, 0x26, 0x0a, 0x74, 0x36, 0x89,
+    0xe3, 0x08, 0x53, 0x25, 0x28, 0xb5, 0x87, 0x9e, 0x33, 0x02, 0x2a, 0x81,
+    0x7b, 0x68, 0xbc, 0xf6, 0xa8, 0x32, 0xdd, 0x2e, 0x9d, 0x55, 0x0e, 0x2f,
+    0x99, 0x31, 0xf4, 0x30, 0xde, 0xcb, 0x69, 0x5e, 0x0b, 0x7f, 0xcb, 0xf1,
+    0xda, 0xd8, 0xbe, 0xce, 0x77, 0x3b, 0xa5, 0x2c, 0xcb, 0xb8, 0xdd, 0xf8,
+    0x20, 0x76, 0xa9, 0xe7, 0x0b, 0x32, 0x3d, 0xf4, 0x36, 0x85, 0xf4, 0xb5,
+    0xb9, 0x76, 0x4d, 0xa2, 0xc9, 0x28, 0x98, 0x64, 0x6c, 0xb3, 0x2b, 0x08,
+    0xdb, 0x7c, 0x24, 0xd0, 0x18, 0x82, 0xc3, 0x24, 0xbc, 0x80, 0x28, 0x65,
+    0xda, 0x50, 0x3c, 0x55, 0x8e, 0x92, 0x32, 0x04, 0x9c, 0x99, 0x5a, 0xab,
+    0xed, 0xc2, 0x54, 0x86, 0x74, 0x72, 0x75, 0x72, 0x27, 0xa6, 0x45, 0xee,
+    0x26, 0x00, 0x7c, 0xe4, 0xaf, 0xf9, 0xaf, 0x8e, 0xeb, 0x3e, 0x41, 0xc5,
+    0x6b, 0x6e, 0x1c, 0xb2, 0xff, 0x28, 0xaa, 0x3f, 0x12, 0xd2, 0x7d, 0x5c,
+    0xd3, 0x74, 0x16, 0x26, 0x67, 0x44, 0x48, 0xcf, 0x1b, 0x7d, 0xbc, 0x3c,
+    0xe9, 0xc1, 0x98, 0xa6, 0xb5, 0xce, 0x35, 0x37, 0xb8, 0xa9, 0xdc, 0x00,
+    0x2e, 0xb0, 0xac, 0x5d, 0xc1, 0x88, 0x59, 0xa2, 0x91, 0x4a, 0x73, 0x56,
+    0x08, 0xa6, 0xff, 0xbd, 0x93, 0x3b, 0xda, 0x05, 0xcd, 0x57, 0x07, 0xfa,
+    0xfb, 0x9b, 0xa2, 0x6e, 0xf0, 0x65, 0x2d, 0xfd, 0xad, 0x8d, 0xdd, 0xc7,
+    0xb6, 0x91, 0xdf, 0xc5, 0xe7, 0x1d, 0x39, 0x1e, 0x93, 0x75, 0x6e, 0x57,
+    0xfb, 0xa1, 0x58, 0x4b, 0xef, 0x8b, 0x62, 0x23, 0xff, 0xd3, 0xe5, 0x42,
+    0x0d, 0x53, 0x62, 0xb4, 0x77, 0xc9, 0xdc, 0xcb, 0x7a, 0xeb, 0x3a, 0x22,
+    0xbc, 0xdd, 0xf6, 0xb4, 0x1f, 0xcf, 0xf4, 0xb5, 0x89, 0x3d, 0xd2, 0xbd,
+    0x14, 0xe5, 0xf9, 0x96, 0x9c, 0x5d, 0xbb, 0x9e, 0x14, 0x53, 0xca, 0x37,
+    0x78, 0xc7, 0xcc, 0x7c, 0x0f, 0x93, 0xa5, 0x70, 0x46, 0xb2, 0x0f, 0x1b,
+    0x3d, 0x67, 0x16, 0x97, 0x6c, 0x8f, 0x20, 0xce, 0x2a, 0xc1, 0x87, 0xad,
+    0xfd, 0x8a, 0xc0, 0x6c, 0x7a, 0x59, 0x55, 0x2a, 0xdc, 0xd2, 0xd1, 0xb6,
+    0x2e, 0x18, 0x9a, 0xd0, 0x2b, 0x55, 0xc0, 0x92, 0x8e, 0x27, 0xee, 0x42,
+    0x43, 0x35, 0x35, 0x69, 0xfe, 0xd1, 0x18, 0x06, 0xea, 0x73, 0x14, 0xbf,
+    0xc2, 0xb8, 0x42, 0x3d, 0x7b, 0x73, 0x7a, 0xe9, 0x5a, 0xe0, 0x8e, 0x26,
+    0x77, 0x56, 0x8e, 0x49, 0xa2, 0x55, 0xd2, 0x7c, 0x74, 0x03, 0xf9, 0x87,
+    0x23, 0x5d, 0x59, 0x78, 0x78, 0xef, 0x15, 0x89, 0x34, 0x75, 0x71, 0x4b,
+    0xc4, 0x07, 0x9c, 0x2a, 0xb5, 0xe5, 0x61, 0x7b, 0xd2, 0x79, 0x30, 0x43,
+    0xdb, 0x74, 0x9e, 0xa1, 0xdf, 0xea, 0x6c, 0xd3, 0x2e, 0xdf, 0x15, 0x0e,
+    0x9e, 0x3c, 0x39, 0x8c, 0x31, 0xa1, 0x63, 0x1b, 0x5c, 0xfc, 0x71, 0xfa,
+    0xfb, 0x97, 0xcb, 0x93, 0xf3, 0x31, 0x1c, 0x84, 0x8f, 0xef, 0x11, 0x8f,
+    0xef, 0x11, 0x8f, 0xef, 0x11, 0x8f, 0xef, 0x11, 0xff, 0xeb, 0xf7, 0x88,
+    0xfb, 0xaf, 0x11, 0x15, 0x3e, 0xb8, 0x50, 0xd1, 0x1c, 0xe3, 0xbb, 0xad,
+    0x98, 0xcc, 0x47, 0x2a, 0xa3, 0xa6, 0x62, 0xa9, 0x79, 0xa9, 0x24, 0xf1,
+    0xf6, 0xec, 0xce, 0xeb, 0x83, 0x5b, 0x7f, 0x77, 0x83, 0xde, 0x9e, 0xfb,
+    0xaa, 0xb6, 0x58, 0x48, 0x82, 0x3a, 0xdf, 0x9e, 0xf0, 0x7f, 0x7a, 0xcc,
+    0xfd, 0x59, 0x1a, 0xda, 0xbb, 0xbb, 0x6f, 0xc6, 0xdc, 0x19, 0x26, 0xac,
+    0x10, 0x54, 0x8d, 0xee, 0x1c, 0xb2, 0x86, 0xe1, 0x62, 0x51, 0x21, 0xdb,
+    0x7d, 0x58, 0xff, 0x6a, 0x28, 0xd4, 0x6c, 0x26, 0x68, 0xa3, 0xb4, 0xe1,
+    0xb5, 0xab, 0xd4, 0x09, 0xfe, 0x32, 0xe4, 0xba, 0x19, 0x50, 0x44, 0x65,
+    0x23, 0x29, 0x64, 0xc9, 0x5d, 0x43, 0x37, 0x6f, 0x34, 0xda, 0x42, 0x4b,
+    0xd0, 0xa5, 0x40, 0x83, 0xc2, 0x71, 0x5f, 0x26, 0x6a, 0x52, 0xdf, 0xd2,
+    0x8d, 0x05, 0xd3, 0x30, 0x77, 0xb3, 0x97, 0xee, 0xdd, 0x35, 0x0e, 0x77,
+    0x24, 0xab, 0x79, 0xb5, 0x7a, 0x4f, 0x34, 0x36, 0xe6, 0xcd, 0x4f, 0x9d,
+    0xcf, 0x03, 0x9e, 0x34, 0xb0, 0x79, 0x83, 0x41, 0xc5, 0x48, 0xf4, 0x69,
+    0xfe, 0x79, 0x70, 0x7b, 0x7b, 0xdb, 0x1c, 0x6c, 0x03, 0x5e, 0xcd, 0xaf,
+    0x7f, 0x00, 0xc8, 0x1e, 0xc4, 0xc6, 0xf2, 0x12, 0x00, 0x00,
+};
+static const unsigned int config_page_gz_len = 1378;
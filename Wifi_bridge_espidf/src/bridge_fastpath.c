@@ -0,0 +1,241 @@
+/*
+ * Zero-copy TX path for the bridge wifi netifs.
+ *
+ * With CONFIG_LWIP_L2_TO_L3_COPY disabled (see sdkconfig.denky32) the
+ * RX direction is already by reference: the wifi driver's buffer is
+ * wrapped in a custom pbuf and released back to the driver when the
+ * stack is done with it. The TX direction however still goes through
+ * the default esp_netif glue, which memcpys every forwarded frame into
+ * a fresh driver buffer — at sustained bridge rates that copy is the
+ * dominant CPU cost.
+ *
+ * This module replaces the linkoutput of the bridge's wifi netifs with
+ * a wrapper that hands contiguous frames to the driver by reference
+ * via esp_wifi_internal_tx_by_ref(): the pbuf's refcount is bumped and
+ * the driver drops it from its TX-done path through the registered
+ * netstack callbacks. Chained pbufs and frames the driver refuses to
+ * take by reference (e.g. while its DMA queue only accepts internal
+ * buffers) fall back to the original copying linkoutput.
+ *
+ * The same hook also coalesces small frames. The driver can only
+ * aggregate (A-MPDU) frames that sit in its TX queue at the same time,
+ * so a stream of tiny MQTT/DNS packets submitted one by one each pays
+ * the full per-frame airtime overhead. Small frames are therefore held
+ * for at most FP_COALESCE_HOLD_US and submitted as one batch — either
+ * when the batch fills, when the hold timer fires, or immediately when
+ * a latency-critical frame (TCP SYN/FIN/RST or a bare ACK) comes
+ * through, which also flushes ahead of itself.
+ */
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "esp_private/wifi.h"
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/tcp.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include "bridge_fastpath.h"
+
+static const char *TAG = "bridge_fastpath";
+
+/* Frames up to this size are candidates for coalescing; the batch is
+ * flushed once it holds FP_COALESCE_MAX frames or after the hold
+ * window, whichever comes first. */
+#define FP_SMALL_FRAME_LEN   256
+#define FP_COALESCE_MAX      8
+#define FP_COALESCE_HOLD_US  2000
+
+struct fp_port {
+    struct netif *netif;
+    netif_linkoutput_fn orig_linkoutput;
+    wifi_interface_t ifx;
+    uint32_t tx_by_ref;
+    uint32_t tx_copied;
+    /* Egress coalescing queue; guarded by mux because the enqueue runs
+     * in the lwIP task and the timed flush in the esp_timer task. */
+    struct pbuf *queue[FP_COALESCE_MAX];
+    int queue_len;
+    esp_timer_handle_t flush_tmr;
+    portMUX_TYPE mux;
+    uint32_t tx_coalesced;
+};
+
+/* STA + AP is all the wifi the chip has. */
+static struct fp_port fp_ports[2];
+static int fp_port_count = 0;
+
+static void *fp_pbuf_ref(void *buf)
+{
+    pbuf_ref((struct pbuf *)buf);
+    return buf;
+}
+
+static void fp_pbuf_free(void *buf)
+{
+    pbuf_free((struct pbuf *)buf);
+}
+
+static struct fp_port *fp_port_for(struct netif *netif)
+{
+    for (int i = 0; i < fp_port_count; i++) {
+        if (fp_ports[i].netif == netif) {
+            return &fp_ports[i];
+        }
+    }
+    return NULL;
+}
+
+static err_t fp_tx_one(struct fp_port *port, struct pbuf *p)
+{
+    /* Only a single contiguous pbuf can be handed over as one driver
+     * buffer; a chain would need gathering, which is just the copy we
+     * are trying to avoid done by hand. */
+    if (p->next == NULL) {
+        if (esp_wifi_internal_tx_by_ref(port->ifx, p->payload, p->len, p) == ESP_OK) {
+            port->tx_by_ref++;
+            return ERR_OK;
+        }
+    }
+
+    port->tx_copied++;
+    return port->orig_linkoutput(port->netif, p);
+}
+
+/* Submit the whole batch back to back so the frames share one driver
+ * queue residency and can be aggregated into a single PPDU. */
+static void fp_flush(struct fp_port *port)
+{
+    struct pbuf *batch[FP_COALESCE_MAX];
+    int n;
+
+    portENTER_CRITICAL(&port->mux);
+    n = port->queue_len;
+    for (int i = 0; i < n; i++) {
+        batch[i] = port->queue[i];
+    }
+    port->queue_len = 0;
+    portEXIT_CRITICAL(&port->mux);
+
+    for (int i = 0; i < n; i++) {
+        fp_tx_one(port, batch[i]);
+        pbuf_free(batch[i]);
+    }
+}
+
+static void fp_flush_tmr_cb(void *arg)
+{
+    fp_flush((struct fp_port *)arg);
+}
+
+/* TCP handshake/teardown frames and bare ACKs must not sit in the hold
+ * window: delaying them stalls the peer's whole window. */
+static int fp_is_urgent(const struct pbuf *p)
+{
+    if (p->len < SIZEOF_ETH_HDR + sizeof(struct ip_hdr) + TCP_HLEN) {
+        return 0;
+    }
+    const struct eth_hdr *eth = (const struct eth_hdr *)p->payload;
+    if (eth->type != PP_HTONS(ETHTYPE_IP)) {
+        return 0;
+    }
+    const struct ip_hdr *ip = (const struct ip_hdr *)((const uint8_t *)p->payload + SIZEOF_ETH_HDR);
+    if (IPH_PROTO(ip) != IP_PROTO_TCP) {
+        return 0;
+    }
+    const struct tcp_hdr *tcp = (const struct tcp_hdr *)((const uint8_t *)ip + IPH_HL_BYTES(ip));
+    uint8_t flags = TCPH_FLAGS(tcp);
+    if (flags & (TCP_SYN | TCP_FIN | TCP_RST)) {
+        return 1;
+    }
+    /* Bare ACK: TCP header and no payload. */
+    uint16_t tcp_len = lwip_ntohs(IPH_LEN(ip)) - IPH_HL_BYTES(ip);
+    return tcp_len == TCPH_HDRLEN_BYTES(tcp);
+}
+
+static err_t fp_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    struct fp_port *port = fp_port_for(netif);
+    if (port == NULL) {
+        return ERR_IF;
+    }
+
+    if (p->tot_len > FP_SMALL_FRAME_LEN || p->next != NULL || fp_is_urgent(p)) {
+        /* Keep ordering: whatever is queued goes out first. */
+        if (port->queue_len > 0) {
+            esp_timer_stop(port->flush_tmr);
+            fp_flush(port);
+        }
+        return fp_tx_one(port, p);
+    }
+
+    pbuf_ref(p);
+    int full;
+    portENTER_CRITICAL(&port->mux);
+    port->queue[port->queue_len++] = p;
+    full = (port->queue_len == FP_COALESCE_MAX);
+    portEXIT_CRITICAL(&port->mux);
+    port->tx_coalesced++;
+
+    if (full) {
+        esp_timer_stop(port->flush_tmr);
+        fp_flush(port);
+    } else if (port->queue_len == 1) {
+        esp_timer_start_once(port->flush_tmr, FP_COALESCE_HOLD_US);
+    }
+    return ERR_OK;
+}
+
+static void fp_wrap_netif(esp_netif_t *esp_netif, wifi_interface_t ifx)
+{
+    struct netif *netif = esp_netif_get_netif_impl(esp_netif);
+    if (netif == NULL || fp_port_count >= 2) {
+        return;
+    }
+    struct fp_port *port = &fp_ports[fp_port_count++];
+    port->netif = netif;
+    port->orig_linkoutput = netif->linkoutput;
+    port->ifx = ifx;
+    portMUX_INITIALIZE(&port->mux);
+    const esp_timer_create_args_t flush_tmr_args = {
+        .callback = &fp_flush_tmr_cb,
+        .arg = port,
+        .name = "fp_flush"
+    };
+    if (esp_timer_create(&flush_tmr_args, &port->flush_tmr) != ESP_OK) {
+        fp_port_count--;
+        return;
+    }
+    netif->linkoutput = fp_linkoutput;
+    ESP_LOGI(TAG, "TX by reference enabled on %s", esp_netif_get_ifkey(esp_netif));
+}
+
+void bridge_fastpath_init(void)
+{
+    /* The driver ref/unrefs the pbuf through these while the frame
+     * sits in its TX queue. */
+    esp_wifi_internal_reg_netstack_buf_cb(fp_pbuf_ref, fp_pbuf_free);
+
+    esp_netif_t *esp_netif = NULL;
+    while ((esp_netif = esp_netif_next_unsafe(esp_netif)) != NULL) {
+        const char *ifkey = esp_netif_get_ifkey(esp_netif);
+        if (strstr(ifkey, "STA") != NULL) {
+            fp_wrap_netif(esp_netif, WIFI_IF_STA);
+        } else if (strstr(ifkey, "AP") != NULL) {
+            fp_wrap_netif(esp_netif, WIFI_IF_AP);
+        }
+    }
+
+    if (fp_port_count == 0) {
+        ESP_LOGW(TAG, "No wifi netif found, TX stays on the copying path");
+    }
+}
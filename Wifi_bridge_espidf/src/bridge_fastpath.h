@@ -0,0 +1,26 @@
+/*
+ * Zero-copy TX path for the bridge wifi netifs.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Switch the wifi netifs' egress to reference-based transmit.
+ *
+ * Interposes on the lwIP linkoutput of every wifi netif the bridge
+ * created and hands contiguous frames to the wifi driver by reference
+ * (refcounted pbuf, released from the driver's TX-done path) instead of
+ * letting the default glue memcpy them into a driver buffer. Chained
+ * pbufs and driver-rejected frames fall back to the original copying
+ * path. Call after esp_bridge_create_all_netif().
+ */
+void bridge_fastpath_init(void);
+
+#ifdef __cplusplus
+}
+#endif
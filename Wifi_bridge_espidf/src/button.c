@@ -11,12 +11,19 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+
+/* Interrupt-driven button handling.
+ *
+ * Nothing runs while the button is idle: the GPIO interrupt arms a
+ * one-shot debounce timer, the debounced level drives a small state
+ * machine, and the long-press detection is another one-shot timer that
+ * only exists between press and release. No polling task, no periodic
+ * wakeups competing with the forwarding tasks.
+ */
 #include <stdio.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
-#include "freertos/timers.h"
+#include <stdlib.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "iot_button.h"
 
@@ -24,291 +31,177 @@
         ESP_LOGE(tag,"%s:%d (%s)", __FILE__, __LINE__, __FUNCTION__);      \
         return (ret);                                                                   \
         }
-#define ERR_ASSERT(tag, param)  IOT_CHECK(tag, (param) == ESP_OK, ESP_FAIL)
 #define POINT_ASSERT(tag, param, ret)    IOT_CHECK(tag, (param) != NULL, (ret))
 
+#ifdef CONFIG_IO_GLITCH_FILTER_TIME_MS
+#define BUTTON_GLITCH_FILTER_TIME_MS   CONFIG_IO_GLITCH_FILTER_TIME_MS
+#else
+#define BUTTON_GLITCH_FILTER_TIME_MS   50
+#endif
+
+/* Press shortly after a release to count as a repeat; hold this long
+ * for BUTTON_LONG_PRESS_START. */
+#define BUTTON_REPEAT_WINDOW_MS        500
+#define BUTTON_LONG_PRESS_TIME_MS      1500
+
 typedef enum {
     BUTTON_STATE_IDLE = 0,
-    BUTTON_STATE_PUSH,
     BUTTON_STATE_PRESSED,
-} button_status_t;
+} button_state_t;
 
-typedef struct button_dev button_dev_t;
-typedef struct btn_cb button_cb_t;
-
-struct btn_cb{
-    TickType_t interval;
+typedef struct {
     button_cb cb;
-    void* arg;
-    TimerHandle_t tmr;
-    button_dev_t *pbtn;
-    button_cb_t *next_cb;
-};
+    void *usr_data;
+} button_cb_slot_t;
 
-struct button_dev{
+typedef struct {
     uint8_t io_num;
     uint8_t active_level;
-    uint32_t serial_thres_sec;
-    button_status_t state;
-    button_cb_t tap_short_cb;
-    button_cb_t tap_psh_cb;
-    button_cb_t tap_rls_cb;
-    button_cb_t press_serial_cb;
-    button_cb_t* cb_head;
-};
+    button_state_t state;
+    uint8_t repeat;
+    int64_t last_release_us;
+    esp_timer_handle_t debounce_tmr;
+    esp_timer_handle_t long_press_tmr;
+    button_cb_slot_t cbs[BUTTON_EVENT_MAX];
+} button_dev_t;
 
-#define BUTTON_GLITCH_FILTER_TIME_MS   CONFIG_IO_GLITCH_FILTER_TIME_MS
-static const char* TAG = "button";
+static const char *TAG = "button";
 
-static void button_press_cb(xTimerHandle tmr)
+static void button_dispatch(button_dev_t *btn, button_event_t event)
 {
-    button_cb_t* btn_cb = (button_cb_t*) pvTimerGetTimerID(tmr);
-    button_dev_t* btn = btn_cb->pbtn;
-    // low, then restart
-    if (btn->active_level == gpio_get_level(btn->io_num)) {
-        btn->state = BUTTON_STATE_PRESSED;
-        if (btn_cb->cb) {
-            btn_cb->cb(btn_cb->arg);
-        }
+    if (btn->cbs[event].cb) {
+        btn->cbs[event].cb(btn, btn->cbs[event].usr_data);
     }
 }
 
-static void button_tap_psh_cb(xTimerHandle tmr)
+static void button_long_press_cb(void *arg)
 {
-    button_cb_t* btn_cb = (button_cb_t*) pvTimerGetTimerID(tmr);
-    button_dev_t* btn = btn_cb->pbtn;
-    xTimerStop(btn->tap_rls_cb.tmr, portMAX_DELAY);
-    int lv = gpio_get_level(btn->io_num);
-
-    if (btn->active_level == lv) {
-        // high, then key is up
-        btn->state = BUTTON_STATE_PUSH;
-        if (btn->press_serial_cb.tmr) {
-            xTimerChangePeriod(btn->press_serial_cb.tmr, btn->serial_thres_sec*1000 / portTICK_PERIOD_MS, portMAX_DELAY);
-            xTimerReset(btn->press_serial_cb.tmr, portMAX_DELAY);
-        }
-        if (btn->tap_psh_cb.cb) {
-            btn->tap_psh_cb.cb(btn->tap_psh_cb.arg);
-        }
-    } else {
-        // 50ms, check if this is a real key up
-        if (btn->tap_rls_cb.tmr) {
-            xTimerStop(btn->tap_rls_cb.tmr, portMAX_DELAY);
-            xTimerReset(btn->tap_rls_cb.tmr, portMAX_DELAY);
-        }
+    button_dev_t *btn = (button_dev_t *)arg;
+    if (btn->state == BUTTON_STATE_PRESSED
+            && gpio_get_level(btn->io_num) == btn->active_level) {
+        button_dispatch(btn, BUTTON_LONG_PRESS_START);
     }
 }
 
-static void button_tap_rls_cb(xTimerHandle tmr)
+/* Runs in the esp_timer task one glitch-filter interval after the last
+ * edge; whatever level the pin shows now is the debounced one. */
+static void button_debounce_cb(void *arg)
 {
-    button_cb_t* btn_cb = (button_cb_t*) pvTimerGetTimerID(tmr);
-    button_dev_t* btn = btn_cb->pbtn;
-    xTimerStop(btn->tap_rls_cb.tmr, portMAX_DELAY);
-    if (btn->active_level == gpio_get_level(btn->io_num)) {
+    button_dev_t *btn = (button_dev_t *)arg;
+    int pressed = (gpio_get_level(btn->io_num) == btn->active_level);
 
-    } else {
-        // high, then key is up
-        button_cb_t *pcb = btn->cb_head;
-        while (pcb != NULL) {
-            if (pcb->tmr != NULL) {
-                xTimerStop(pcb->tmr, portMAX_DELAY);
-            }
-            pcb = pcb->next_cb;
-        }
-        if (btn->press_serial_cb.tmr && btn->press_serial_cb.tmr != NULL) {
-            xTimerStop(btn->press_serial_cb.tmr, portMAX_DELAY);
-        }
-        if (btn->tap_short_cb.cb && btn->state == BUTTON_STATE_PUSH) {
-            btn->tap_short_cb.cb(btn->tap_short_cb.arg);
-        }
-        if(btn->tap_rls_cb.cb && btn->state != BUTTON_STATE_IDLE) {
-            btn->tap_rls_cb.cb(btn->tap_rls_cb.arg);
+    if (pressed && btn->state == BUTTON_STATE_IDLE) {
+        btn->state = BUTTON_STATE_PRESSED;
+        int64_t now = esp_timer_get_time();
+        if (now - btn->last_release_us < (int64_t)BUTTON_REPEAT_WINDOW_MS * 1000) {
+            btn->repeat++;
+            button_dispatch(btn, BUTTON_PRESS_REPEAT);
+        } else {
+            btn->repeat = 1;
         }
+        button_dispatch(btn, BUTTON_PRESS_DOWN);
+        esp_timer_start_once(btn->long_press_tmr, (int64_t)BUTTON_LONG_PRESS_TIME_MS * 1000);
+    } else if (!pressed && btn->state == BUTTON_STATE_PRESSED) {
         btn->state = BUTTON_STATE_IDLE;
-    }
-}
-
-static void button_press_serial_cb(xTimerHandle tmr)
-{
-    button_dev_t* btn = (button_dev_t*) pvTimerGetTimerID(tmr);
-    if (btn->press_serial_cb.cb) {
-        btn->press_serial_cb.cb(btn->press_serial_cb.arg);
-    }
-    xTimerChangePeriod(btn->press_serial_cb.tmr, btn->press_serial_cb.interval, portMAX_DELAY);
-    xTimerReset(btn->press_serial_cb.tmr, portMAX_DELAY);
-}
-
-static void button_gpio_isr_handler(void* arg)
-{
-    button_dev_t* btn = (button_dev_t*) arg;
-    portBASE_TYPE HPTaskAwoken = pdFALSE;
-    int level = gpio_get_level(btn->io_num);
-    if (level == btn->active_level) {
-        if (btn->tap_psh_cb.tmr) {
-            xTimerStopFromISR(btn->tap_psh_cb.tmr, &HPTaskAwoken);
-            xTimerResetFromISR(btn->tap_psh_cb.tmr, &HPTaskAwoken);
-        }
-
-        button_cb_t *pcb = btn->cb_head;
-        while (pcb != NULL) {
-            if (pcb->tmr != NULL) {
-                xTimerStopFromISR(pcb->tmr, &HPTaskAwoken);
-                xTimerResetFromISR(pcb->tmr, &HPTaskAwoken);
-            }
-            pcb = pcb->next_cb;
-        }
-    } else {
-        // 50ms, check if this is a real key up
-        if (btn->tap_rls_cb.tmr) {
-            xTimerStopFromISR(btn->tap_rls_cb.tmr, &HPTaskAwoken);
-            xTimerResetFromISR(btn->tap_rls_cb.tmr, &HPTaskAwoken);
+        btn->last_release_us = esp_timer_get_time();
+        esp_timer_stop(btn->long_press_tmr);
+        button_dispatch(btn, BUTTON_PRESS_UP);
+        if (btn->repeat == 1) {
+            button_dispatch(btn, BUTTON_SINGLE_CLICK);
         }
     }
-    if(HPTaskAwoken == pdTRUE) {
-        portYIELD_FROM_ISR();
-    }
 }
 
-static void button_free_tmr(xTimerHandle* tmr)
+/* Any edge just (re)arms the debounce timer; the timer callback does
+ * the actual sampling so bounces collapse into one event. */
+static void button_gpio_isr_handler(void *arg)
 {
-    if (tmr && *tmr) {
-        xTimerStop(*tmr, portMAX_DELAY);
-        xTimerDelete(*tmr, portMAX_DELAY);
-        *tmr = NULL;
-    }
+    button_dev_t *btn = (button_dev_t *)arg;
+    esp_timer_stop(btn->debounce_tmr);
+    esp_timer_start_once(btn->debounce_tmr, (int64_t)BUTTON_GLITCH_FILTER_TIME_MS * 1000);
 }
 
-esp_err_t iot_button_delete(button_handle_t btn_handle)
+button_handle_t iot_button_create(const button_config_t *config)
 {
-    POINT_ASSERT(TAG, btn_handle, ESP_ERR_INVALID_ARG);
-    button_dev_t* btn = (button_dev_t*) btn_handle;
-    gpio_set_intr_type(btn->io_num, GPIO_INTR_DISABLE);
-    gpio_isr_handler_remove(btn->io_num);
+    POINT_ASSERT(TAG, config, NULL);
+    IOT_CHECK(TAG, config->type == BUTTON_TYPE_GPIO, NULL);
+    IOT_CHECK(TAG, config->gpio_button_config.gpio_num < GPIO_NUM_MAX, NULL);
 
-    button_free_tmr(&btn->tap_rls_cb.tmr);
-    button_free_tmr(&btn->tap_psh_cb.tmr);
-    button_free_tmr(&btn->tap_short_cb.tmr);
-    button_free_tmr(&btn->press_serial_cb.tmr);
+    button_dev_t *btn = (button_dev_t *)calloc(1, sizeof(button_dev_t));
+    POINT_ASSERT(TAG, btn, NULL);
+    btn->io_num = config->gpio_button_config.gpio_num;
+    btn->active_level = config->gpio_button_config.active_level;
+    btn->state = BUTTON_STATE_IDLE;
 
-    button_cb_t *pcb = btn->cb_head;
-    while (pcb != NULL) {
-        button_cb_t *cb_next = pcb->next_cb;
-        button_free_tmr(&pcb->tmr);
-        free(pcb);
-        pcb = cb_next;
+    const esp_timer_create_args_t debounce_args = {
+        .callback = &button_debounce_cb,
+        .arg = btn,
+        .name = "btn_debounce"
+    };
+    const esp_timer_create_args_t long_press_args = {
+        .callback = &button_long_press_cb,
+        .arg = btn,
+        .name = "btn_long"
+    };
+    if (esp_timer_create(&debounce_args, &btn->debounce_tmr) != ESP_OK
+            || esp_timer_create(&long_press_args, &btn->long_press_tmr) != ESP_OK) {
+        ESP_LOGE(TAG, "timer create failed");
+        if (btn->debounce_tmr) {
+            esp_timer_delete(btn->debounce_tmr);
+        }
+        free(btn);
+        return NULL;
     }
-    free(btn);
-    return ESP_OK;
-}
 
-button_handle_t iot_button_create(gpio_num_t gpio_num, button_active_t active_level)
-{
-    IOT_CHECK(TAG, gpio_num < GPIO_NUM_MAX, NULL);
-    button_dev_t* btn = (button_dev_t*) calloc(1, sizeof(button_dev_t));
-    POINT_ASSERT(TAG, btn, NULL);
-    btn->active_level = active_level;
-    btn->io_num = gpio_num;
-    btn->state = BUTTON_STATE_IDLE;
-    btn->tap_rls_cb.arg = NULL;
-    btn->tap_rls_cb.cb = NULL;
-    btn->tap_rls_cb.interval = BUTTON_GLITCH_FILTER_TIME_MS / portTICK_PERIOD_MS;
-    btn->tap_rls_cb.pbtn = btn;
-    btn->tap_rls_cb.tmr = xTimerCreate("btn_rls_tmr", btn->tap_rls_cb.interval, pdFALSE,
-            &btn->tap_rls_cb, button_tap_rls_cb);
-    btn->tap_psh_cb.arg = NULL;
-    btn->tap_psh_cb.cb = NULL;
-    btn->tap_psh_cb.interval = BUTTON_GLITCH_FILTER_TIME_MS / portTICK_PERIOD_MS;
-    btn->tap_psh_cb.pbtn = btn;
-    btn->tap_psh_cb.tmr = xTimerCreate("btn_psh_tmr", btn->tap_psh_cb.interval, pdFALSE,
-            &btn->tap_psh_cb, button_tap_psh_cb);
     gpio_install_isr_service(0);
-    gpio_config_t gpio_conf;
-    gpio_conf.intr_type = GPIO_INTR_ANYEDGE;
-    gpio_conf.mode = GPIO_MODE_INPUT;
-    gpio_conf.pin_bit_mask = (1 << gpio_num);
-    gpio_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    gpio_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    gpio_config_t gpio_conf = {
+        .intr_type = GPIO_INTR_ANYEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = (1ULL << btn->io_num),
+        .pull_down_en = btn->active_level ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = btn->active_level ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE,
+    };
     gpio_config(&gpio_conf);
-    gpio_isr_handler_add(gpio_num, button_gpio_isr_handler, btn);
-    return (button_handle_t) btn;
+    gpio_isr_handler_add(btn->io_num, button_gpio_isr_handler, btn);
+    return (button_handle_t)btn;
 }
 
-esp_err_t iot_button_rm_cb(button_handle_t btn_handle, button_cb_type_t type)
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, button_cb cb, void *usr_data)
 {
-    button_dev_t* btn = (button_dev_t*) btn_handle;
-    button_cb_t* btn_cb = NULL;
-    if (type == BUTTON_CB_PUSH) {
-        btn_cb = &btn->tap_psh_cb;
-    } else if (type == BUTTON_CB_RELEASE) {
-        btn_cb = &btn->tap_rls_cb;
-    } else if (type == BUTTON_CB_TAP) {
-        btn_cb = &btn->tap_short_cb;
-    } else if (type == BUTTON_CB_SERIAL) {
-        btn_cb = &btn->press_serial_cb;
-    }
-    btn_cb->cb = NULL;
-    btn_cb->arg = NULL;
-    btn_cb->pbtn = btn;
-    button_free_tmr(&btn_cb->tmr);
+    POINT_ASSERT(TAG, btn_handle, ESP_ERR_INVALID_ARG);
+    IOT_CHECK(TAG, event < BUTTON_EVENT_MAX, ESP_ERR_INVALID_ARG);
+    button_dev_t *btn = (button_dev_t *)btn_handle;
+    btn->cbs[event].cb = cb;
+    btn->cbs[event].usr_data = usr_data;
     return ESP_OK;
 }
 
-esp_err_t iot_button_set_serial_cb(button_handle_t btn_handle, uint32_t start_after_sec, TickType_t interval_tick, button_cb cb, void* arg)
+esp_err_t iot_button_unregister_cb(button_handle_t btn_handle, button_event_t event)
 {
-    button_dev_t* btn = (button_dev_t*) btn_handle;
-    btn->serial_thres_sec = start_after_sec;
-    if (btn->press_serial_cb.tmr == NULL) {
-        btn->press_serial_cb.tmr = xTimerCreate("btn_serial_tmr", btn->serial_thres_sec*1000 / portTICK_PERIOD_MS,
-                            pdFALSE, btn, button_press_serial_cb);
-    }
-    btn->press_serial_cb.arg = arg;
-    btn->press_serial_cb.cb = cb;
-    btn->press_serial_cb.interval = interval_tick;
-    btn->press_serial_cb.pbtn = btn;
-    xTimerChangePeriod(btn->press_serial_cb.tmr, btn->serial_thres_sec*1000 / portTICK_PERIOD_MS, portMAX_DELAY);
+    POINT_ASSERT(TAG, btn_handle, ESP_ERR_INVALID_ARG);
+    IOT_CHECK(TAG, event < BUTTON_EVENT_MAX, ESP_ERR_INVALID_ARG);
+    button_dev_t *btn = (button_dev_t *)btn_handle;
+    btn->cbs[event].cb = NULL;
+    btn->cbs[event].usr_data = NULL;
     return ESP_OK;
 }
 
-esp_err_t iot_button_set_evt_cb(button_handle_t btn_handle, button_cb_type_t type, button_cb cb, void* arg)
+uint8_t iot_button_get_repeat(button_handle_t btn_handle)
 {
-    POINT_ASSERT(TAG, btn_handle, ESP_ERR_INVALID_ARG);
-    button_dev_t* btn = (button_dev_t*) btn_handle;
-    if (type == BUTTON_CB_PUSH) {
-        btn->tap_psh_cb.arg = arg;
-        btn->tap_psh_cb.cb = cb;
-        btn->tap_psh_cb.interval = BUTTON_GLITCH_FILTER_TIME_MS / portTICK_RATE_MS;
-        btn->tap_psh_cb.pbtn = btn;
-        xTimerChangePeriod(btn->tap_psh_cb.tmr, btn->tap_psh_cb.interval, portMAX_DELAY);
-    } else if (type == BUTTON_CB_RELEASE) {
-        btn->tap_rls_cb.arg = arg;
-        btn->tap_rls_cb.cb = cb;
-        btn->tap_rls_cb.interval = BUTTON_GLITCH_FILTER_TIME_MS / portTICK_RATE_MS;
-        btn->tap_rls_cb.pbtn = btn;
-        xTimerChangePeriod(btn->tap_rls_cb.tmr, btn->tap_psh_cb.interval, portMAX_DELAY);
-    } else if (type == BUTTON_CB_TAP) {
-        btn->tap_short_cb.arg = arg;
-        btn->tap_short_cb.cb = cb;
-        btn->tap_short_cb.interval = BUTTON_GLITCH_FILTER_TIME_MS / portTICK_RATE_MS;
-        btn->tap_short_cb.pbtn = btn;
-    } else if (type == BUTTON_CB_SERIAL) {
-        iot_button_set_serial_cb(btn_handle, 1, 1000 / portTICK_RATE_MS, cb, arg);
-    }
-    return ESP_OK;
+    POINT_ASSERT(TAG, btn_handle, 0);
+    return ((button_dev_t *)btn_handle)->repeat;
 }
 
-esp_err_t iot_button_add_custom_cb(button_handle_t btn_handle, uint32_t press_sec, button_cb cb, void* arg)
+esp_err_t iot_button_delete(button_handle_t btn_handle)
 {
     POINT_ASSERT(TAG, btn_handle, ESP_ERR_INVALID_ARG);
-    IOT_CHECK(TAG, press_sec != 0, ESP_ERR_INVALID_ARG);
-    button_dev_t* btn = (button_dev_t*) btn_handle;
-    button_cb_t* cb_new = (button_cb_t*) calloc(1, sizeof(button_cb_t));
-    POINT_ASSERT(TAG, cb_new, ESP_FAIL);
-    cb_new->arg = arg;
-    cb_new->cb = cb;
-    cb_new->interval = press_sec * 1000 / portTICK_PERIOD_MS;
-    cb_new->pbtn = btn;
-    cb_new->tmr = xTimerCreate("btn_press_tmr", cb_new->interval, pdFALSE, cb_new, button_press_cb);
-    cb_new->next_cb = btn->cb_head;
-    btn->cb_head = cb_new;
+    button_dev_t *btn = (button_dev_t *)btn_handle;
+    gpio_set_intr_type(btn->io_num, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove(btn->io_num);
+    esp_timer_stop(btn->debounce_tmr);
+    esp_timer_delete(btn->debounce_tmr);
+    esp_timer_stop(btn->long_press_tmr);
+    esp_timer_delete(btn->long_press_tmr);
+    free(btn);
     return ESP_OK;
-}
\ No newline at end of file
+}
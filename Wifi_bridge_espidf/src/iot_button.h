@@ -19,88 +19,83 @@ extern "C" {
 #endif
 
 #include "driver/gpio.h"
-#include "freertos/portmacro.h"
-typedef void (* button_cb)(void*);
-typedef void* button_handle_t;
+
+typedef void (* button_cb)(void *hardware_data, void *usr_data);
+typedef void *button_handle_t;
 
 typedef enum {
-    BUTTON_ACTIVE_HIGH = 1,    /*!<button active level: high level*/
-    BUTTON_ACTIVE_LOW = 0,     /*!<button active level: low level*/
-} button_active_t;
+    BUTTON_PRESS_DOWN = 0,    /*!<button pressed */
+    BUTTON_PRESS_UP,          /*!<button released */
+    BUTTON_PRESS_REPEAT,      /*!<button pressed again shortly after a release */
+    BUTTON_SINGLE_CLICK,      /*!<button pressed and released once */
+    BUTTON_LONG_PRESS_START,  /*!<button held longer than the long-press time */
+    BUTTON_EVENT_MAX,
+} button_event_t;
 
 typedef enum {
-    BUTTON_CB_PUSH = 0,   /*!<button push callback event */
-    BUTTON_CB_RELEASE,    /*!<button release callback event */
-    BUTTON_CB_TAP,        /*!<button quick tap callback event(will not trigger if there already is a "PRESS" event) */
-    BUTTON_CB_SERIAL,     /*!<button serial trigger callback event */
-} button_cb_type_t;
+    BUTTON_TYPE_GPIO = 0,     /*!<button connected to a GPIO */
+} button_type_t;
+
+typedef struct {
+    int32_t gpio_num;         /*!<GPIO index of the pin that the button uses */
+    uint8_t active_level;     /*!<GPIO level when the button is pressed */
+} button_gpio_config_t;
+
+typedef struct {
+    button_type_t type;
+    button_gpio_config_t gpio_button_config;
+} button_config_t;
 
 /**
- * @brief Init button functions
+ * @brief Create a button object.
+ *
+ * The button is fully interrupt driven: a GPIO edge arms a one-shot
+ * debounce timer and all further timing (repeat window, long press)
+ * runs on one-shot esp_timers, so an idle button costs no wakeups.
  *
- * @param gpio_num GPIO index of the pin that the button uses
- * @param active_level button hardware active level.
- *        For "BUTTON_ACTIVE_LOW" it means when the button pressed, the GPIO will read low level.
+ * @param config button configuration
  *
  * @return A button_handle_t handle to the created button object, or NULL in case of error.
  */
-button_handle_t iot_button_create(gpio_num_t gpio_num, button_active_t active_level);
+button_handle_t iot_button_create(const button_config_t *config);
 
 /**
- * @brief Register a callback function for a serial trigger event.
+ * @brief Register a callback function for a button event.
  *
  * @param btn_handle handle of the button object
- * @start_after_sec define the time after which to start serial trigger action
- * @interval_tick serial trigger interval
- * @cb callback function for "TAP" action.
- * @arg Parameter for callback function
+ * @param event event to hook
+ * @param cb callback; receives the button handle as hardware_data
+ * @param usr_data parameter passed through to the callback
  * @note
- *        Button callback functions execute in the context of the timer service task.
- *        It is therefore essential that button callback functions never attempt to block.
- *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
- *        or specify a non zero block time when accessing a queue or a semaphore.
+ *        Button callback functions execute in the context of the esp_timer
+ *        task. It is therefore essential that button callback functions
+ *        never attempt to block.
  * @return
  *     - ESP_OK Success
- *     - ESP_FAIL Parameter error
+ *     - ESP_ERR_INVALID_ARG Parameter error
  */
-esp_err_t iot_button_set_serial_cb(button_handle_t btn_handle, uint32_t start_after_sec, TickType_t interval_tick, button_cb cb, void* arg);
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, button_cb cb, void *usr_data);
 
 /**
- * @brief Register a callback function for a button_cb_type_t action.
+ * @brief Unregister the callback for a button event.
  *
  * @param btn_handle handle of the button object
- * @param type callback function type
- * @param cb callback function for "TAP" action.
- * @param arg Parameter for callback function
- * @note
- *        Button callback functions execute in the context of the timer service task.
- *        It is therefore essential that button callback functions never attempt to block.
- *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
- *        or specify a non zero block time when accessing a queue or a semaphore.
+ * @param event event to unhook
+ *
  * @return
  *     - ESP_OK Success
- *     - ESP_FAIL Parameter error
+ *     - ESP_ERR_INVALID_ARG Parameter error
  */
-esp_err_t iot_button_set_evt_cb(button_handle_t btn_handle, button_cb_type_t type, button_cb cb, void* arg);
+esp_err_t iot_button_unregister_cb(button_handle_t btn_handle, button_event_t event);
 
 /**
- * @brief
+ * @brief Number of presses in the current repeat sequence.
  *
  * @param btn_handle handle of the button object
- * @param press_sec the callback function would be called if you press the button for a specified period of time
- * @param cb callback function for "PRESS" action.
- * @param arg Parameter for callback function
  *
- * @note
- *        Button callback functions execute in the context of the timer service task.
- *        It is therefore essential that button callback functions never attempt to block.
- *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
- *        or specify a non zero block time when accessing a queue or a semaphore.
- * @return
- *     - ESP_OK Success
- *     - ESP_FAIL Parameter error
+ * @return press count, 1 for the first press
  */
-esp_err_t iot_button_add_custom_cb(button_handle_t btn_handle, uint32_t press_sec, button_cb cb, void* arg);
+uint8_t iot_button_get_repeat(button_handle_t btn_handle);
 
 /**
  * @brief Delete button object and free memory
@@ -108,123 +103,12 @@ esp_err_t iot_button_add_custom_cb(button_handle_t btn_handle, uint32_t press_se
  *
  * @return
  *     - ESP_OK Success
- *     - ESP_FAIL Parameter error
+ *     - ESP_ERR_INVALID_ARG Parameter error
  */
 esp_err_t iot_button_delete(button_handle_t btn_handle);
 
-/**
- * @brief Remove callback
- *
- * @param btn_handle The handle of the button object
- * @param type callback function event type
- *
- * @return
- *     - ESP_OK Success
- */
-esp_err_t iot_button_rm_cb(button_handle_t btn_handle, button_cb_type_t type);
-
 #ifdef __cplusplus
 }
 #endif
 
-#ifdef __cplusplus
-
-/**
- * class of button
- * simple usage:
- * CButton* btn = new CButton(BUTTON_IO_NUM, BUTTON_ACTIVE_LEVEL, BUTTON_SERIAL_TRIGGER, 3);
- * btn->add_cb(BUTTON_CB_PUSH, button_tap_cb, (void*) push, 50 / portTICK_PERIOD_MS);
- * btn->add_custom_cb(5, button_press_5s_cb, NULL);
- * ......
- * delete btn;
- */
-class CButton
-{
-private:
-    button_handle_t m_btn_handle;
-
-    /**
-     * prevent copy constructing
-     */
-    CButton(const CButton&);
-    CButton& operator = (const CButton&);
-public:
-
-    /**
-     * @brief constructor of CButton
-     * 
-     * @param gpio_num GPIO index of the pin that the button uses
-     * @param active_level button hardware active level.
-     *        For "BUTTON_ACTIVE_LOW" it means when the button pressed, the GPIO will read low level.
-     */
-    CButton(gpio_num_t gpio_num, button_active_t active_level = BUTTON_ACTIVE_LOW);
-    
-    ~CButton();
-
-    /**
-     * @brief Register a callback function for a button_cb_type_t action.
-     *
-     * @param type callback function type
-     * @param cb callback function for "TAP" action.
-     * @param arg Parameter for callback function
-     * @note
-     *        Button callback functions execute in the context of the timer service task.
-     *        It is therefore essential that button callback functions never attempt to block.
-     *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
-     *        or specify a non zero block time when accessing a queue or a semaphore.
-     * @return
-     *     - ESP_OK Success
-     *     - ESP_FAIL Parameter error
-     */
-    esp_err_t set_evt_cb(button_cb_type_t type, button_cb cb, void* arg);
-
-    /**
-     * @brief Register a callback function for a serial trigger event.
-     *
-     * @param btn_handle handle of the button object
-     * @start_after_sec define the time after which to start serial trigger action
-     * @interval_tick serial trigger interval
-     * @cb callback function for "TAP" action.
-     * @arg Parameter for callback function
-     * @note
-     *        Button callback functions execute in the context of the timer service task.
-     *        It is therefore essential that button callback functions never attempt to block.
-     *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
-     *        or specify a non zero block time when accessing a queue or a semaphore.
-     * @return
-     *     - ESP_OK Success
-     *     - ESP_FAIL Parameter error
-     */
-    esp_err_t set_serial_cb(button_cb cb, void* arg, TickType_t interval_tick, uint32_t start_after_sec);
-
-    /**
-     * @brief
-     *
-     * @param press_sec the callback function would be called if you press the button for a specified period of time
-     * @param cb callback function for "PRESS" action.
-     * @param arg Parameter for callback function
-     *
-     * @note
-     *        Button callback functions execute in the context of the timer service task.
-     *        It is therefore essential that button callback functions never attempt to block.
-     *        For example, a button callback function must not call vTaskDelay(), vTaskDelayUntil(),
-     *        or specify a non zero block time when accessing a queue or a semaphore.
-     * @return
-     *     - ESP_OK Success
-     *     - ESP_FAIL Parameter error
-     */
-    esp_err_t add_custom_cb(uint32_t press_sec, button_cb cb, void* arg);
-
-    /**
-     * @brief Remove callback
-     *
-     * @param type callback function event type
-     *
-     * @return
-     *     - ESP_OK Success
-     */
-    esp_err_t rm_cb(button_cb_type_t type);
-};
 #endif
-
-#endif
\ No newline at end of file
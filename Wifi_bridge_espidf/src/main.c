@@ -17,7 +17,11 @@
 #include "esp_system.h"
 #include "esp_event.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "esp_bridge.h"
+#include "bridge_fastpath.h"
 #if defined(CONFIG_APP_BRIDGE_USE_WEB_SERVER)
 #include "web_server.h"
 #endif
@@ -101,6 +105,25 @@ static void esp_bridge_create_button(void)
     iot_button_register_cb(g_btns[0], BUTTON_LONG_PRESS_START, button_long_press_start_cb, 0);
 }
 
+/* Everything a client doesn't need to pass traffic. Runs at low
+ * priority once the forwarding path is already up, so a deliberate
+ * failover reboot is back to carrying frames before the button, web
+ * server and provisioning have even started to initialize. */
+static void deferred_init_task(void *arg)
+{
+    esp_bridge_create_button();
+
+#if defined(CONFIG_APP_BRIDGE_USE_WEB_SERVER)
+    StartWebServer();
+#endif /* CONFIG_APP_BRIDGE_USE_WEB_SERVER */
+#if defined(CONFIG_APP_BRIDGE_USE_WIFI_PROVISIONING_OVER_BLE)
+    esp_bridge_wifi_prov_mgr();
+#endif /* CONFIG_APP_BRIDGE_USE_WIFI_PROVISIONING_OVER_BLE */
+
+    ESP_LOGI(TAG, "Deferred init done");
+    vTaskDelete(NULL);
+}
+
 void app_main(void)
 {
     esp_log_level_set("*", ESP_LOG_INFO);
@@ -110,6 +133,8 @@ void app_main(void)
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
+    /* Critical path: get the radios associated and the netifs
+     * forwarding as early as possible. */
     esp_bridge_create_all_netif();
 
 #if defined(CONFIG_BRIDGE_DATA_FORWARDING_NETIF_SOFTAP)
@@ -124,12 +149,8 @@ void app_main(void)
 #if defined(CONFIG_BRIDGE_EXTERNAL_NETIF_STATION)
     esp_wifi_connect();
 #endif
-    esp_bridge_create_button();
+    bridge_fastpath_init();
 
-#if defined(CONFIG_APP_BRIDGE_USE_WEB_SERVER)
-    StartWebServer();
-#endif /* CONFIG_APP_BRIDGE_USE_WEB_SERVER */
-#if defined(CONFIG_APP_BRIDGE_USE_WIFI_PROVISIONING_OVER_BLE)
-    esp_bridge_wifi_prov_mgr();
-#endif /* CONFIG_APP_BRIDGE_USE_WIFI_PROVISIONING_OVER_BLE */
+    xTaskCreate(deferred_init_task, "deferred_init", 4096, NULL,
+                tskIDLE_PRIORITY + 1, NULL);
 }
\ No newline at end of file
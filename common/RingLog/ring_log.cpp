@@ -0,0 +1,83 @@
+#include "ring_log.h"
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define RL_CAPACITY   64   // power of two
+#define RL_MASK       (RL_CAPACITY - 1)
+#define RL_TASK_PRIO  1
+#define RL_DRAIN_MS   20
+
+typedef struct {
+  const char *fmt;
+  uint32_t args[4];
+  volatile uint32_t seq;  // claim index + 1 once the record is committed
+} rl_record_t;
+
+static rl_record_t s_ring[RL_CAPACITY];
+static volatile uint32_t s_head = 0;  // next slot to claim (writers)
+static uint32_t s_tail = 0;           // next slot to drain (drainer only)
+static uint32_t s_dropped = 0;
+static TaskHandle_t s_drain_task = NULL;
+
+void ring_log(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+              uint32_t a3) {
+  uint32_t idx = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+  rl_record_t *rec = &s_ring[idx & RL_MASK];
+  rec->fmt = fmt;
+  rec->args[0] = a0;
+  rec->args[1] = a1;
+  rec->args[2] = a2;
+  rec->args[3] = a3;
+  // The seq store publishes the record; drainer skips slots whose seq
+  // does not match, so a torn overwrite is dropped rather than printed.
+  __atomic_store_n(&rec->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t ring_log_dropped(void) {
+  return s_dropped;
+}
+
+static void rl_drain_task(void *arg) {
+  char line[128];
+  while (true) {
+    uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    if (s_tail == head) {
+      vTaskDelay(pdMS_TO_TICKS(RL_DRAIN_MS));
+      continue;
+    }
+    if (head - s_tail > RL_CAPACITY) {
+      // Writers lapped us; jump to the oldest intact record.
+      s_dropped += head - RL_CAPACITY - s_tail;
+      s_tail = head - RL_CAPACITY;
+    }
+    rl_record_t *rec = &s_ring[s_tail & RL_MASK];
+    uint32_t seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+    if (seq != s_tail + 1) {
+      // Slot already reclaimed by a faster writer; count and move on.
+      s_dropped++;
+      s_tail++;
+      continue;
+    }
+    int len = snprintf(line, sizeof(line), rec->fmt, rec->args[0],
+                       rec->args[1], rec->args[2], rec->args[3]);
+    s_tail++;
+    if (len > 0) {
+      if (len >= (int)sizeof(line)) {
+        len = sizeof(line) - 1;
+      }
+      Serial.write((const uint8_t *)line, len);
+      Serial.write('\n');
+    }
+  }
+}
+
+void ring_log_init(void) {
+  if (s_drain_task) {
+    return;
+  }
+  xTaskCreate(rl_drain_task, "ring_log", 3072, NULL, RL_TASK_PRIO,
+              &s_drain_task);
+}
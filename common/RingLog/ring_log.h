@@ -0,0 +1,30 @@
+/*
+  Lock-free ring-buffered async logging, shared across the firmwares.
+
+  Synchronous Serial prints cost ~1 ms each at 115200 baud, which is an
+  eternity in a capture loop or a servo tick. Here writers only claim a
+  slot with an atomic increment and store a format pointer plus up to
+  four integer arguments — callable from any task or ISR — and a
+  low-priority drainer task does the formatting and UART output.
+
+  The format string must be a literal (the ring stores the pointer, not
+  the text). When producers outrun the drainer the oldest records are
+  overwritten and counted, never blocked on.
+*/
+#ifndef RING_LOG_H
+#define RING_LOG_H
+
+#include <stdint.h>
+
+// Starts the drainer task; safe to call more than once.
+void ring_log_init(void);
+
+// Queues one record. fmt must be a string literal using integer
+// conversions only (%d/%u/%x/%c); up to four arguments.
+void ring_log(const char *fmt, uint32_t a0 = 0, uint32_t a1 = 0,
+              uint32_t a2 = 0, uint32_t a3 = 0);
+
+// Records lost to overwrite since boot.
+uint32_t ring_log_dropped(void);
+
+#endif // RING_LOG_H
@@ -20,6 +20,7 @@
 #include "esp_err.h"
 #include "cmd_nvs.h"
 #include "nvs.h"
+#include "mbedtls/base64.h"
 
 typedef struct {
     nvs_type_t type;
@@ -507,6 +508,248 @@ static int list_entries(int argc, char **argv)
     return list(part, name, type);
 }
 
+
+/* ---- namespace export / import ------------------------------------- */
+
+/* Provisioning a replacement unit used to be a scripted dialogue of
+ * dozens of nvs_set round trips over 115200-baud UART. These commands
+ * move a whole namespace as one length-prefixed binary blob, base64 on
+ * the wire: nvs_export prints it, nvs_import reads it back from pasted
+ * console lines (the command line itself is capped at 256 chars).
+ *
+ * Blob layout: "NVX1" magic, u16 record count, then per record
+ * [u8 type][u8 keylen][key][u32 len][data]. */
+
+#define EXPORT_MAGIC     "NVX1"
+#define EXPORT_BUF_SIZE  4096
+#define EXPORT_LINE_LEN  64
+
+static esp_err_t export_append(uint8_t *buf, size_t *off, const void *data, size_t len)
+{
+    if (*off + len > EXPORT_BUF_SIZE) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(buf + *off, data, len);
+    *off += len;
+    return ESP_OK;
+}
+
+static esp_err_t export_read_value(nvs_handle_t nvs, const nvs_entry_info_t *info,
+                                   uint8_t *val, size_t *len)
+{
+    esp_err_t err;
+    switch (info->type) {
+        case NVS_TYPE_I8:  *len = 1; err = nvs_get_i8(nvs, info->key, (int8_t *)val); break;
+        case NVS_TYPE_U8:  *len = 1; err = nvs_get_u8(nvs, info->key, (uint8_t *)val); break;
+        case NVS_TYPE_I16: *len = 2; err = nvs_get_i16(nvs, info->key, (int16_t *)val); break;
+        case NVS_TYPE_U16: *len = 2; err = nvs_get_u16(nvs, info->key, (uint16_t *)val); break;
+        case NVS_TYPE_I32: *len = 4; err = nvs_get_i32(nvs, info->key, (int32_t *)val); break;
+        case NVS_TYPE_U32: *len = 4; err = nvs_get_u32(nvs, info->key, (uint32_t *)val); break;
+        case NVS_TYPE_I64: *len = 8; err = nvs_get_i64(nvs, info->key, (int64_t *)val); break;
+        case NVS_TYPE_U64: *len = 8; err = nvs_get_u64(nvs, info->key, (uint64_t *)val); break;
+        case NVS_TYPE_STR:
+            *len = EXPORT_BUF_SIZE;
+            err = nvs_get_str(nvs, info->key, (char *)val, len);
+            break;
+        case NVS_TYPE_BLOB:
+            *len = EXPORT_BUF_SIZE;
+            err = nvs_get_blob(nvs, info->key, val, len);
+            break;
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+    return err;
+}
+
+static int export_namespace(int argc, char **argv)
+{
+    nvs_handle_t nvs;
+    nvs_iterator_t it = NULL;
+    uint8_t *buf = NULL;
+    uint8_t *val = NULL;
+    unsigned char *b64 = NULL;
+    size_t off = 0;
+    uint16_t count = 0;
+    int ret = 1;
+
+    esp_err_t err = nvs_open(current_namespace, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "%s", esp_err_to_name(err));
+        return 1;
+    }
+
+    buf = malloc(EXPORT_BUF_SIZE);
+    val = malloc(EXPORT_BUF_SIZE);
+    if (buf == NULL || val == NULL) {
+        goto out;
+    }
+
+    /* Reserve space for the header, fill the count in afterwards. */
+    off = 4 + 2;
+    memcpy(buf, EXPORT_MAGIC, 4);
+
+    err = nvs_entry_find("nvs", current_namespace, NVS_TYPE_ANY, &it);
+    while (err == ESP_OK && it != NULL) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        size_t vlen;
+        if (export_read_value(nvs, &info, val, &vlen) == ESP_OK) {
+            uint8_t type = (uint8_t)info.type;
+            uint8_t keylen = (uint8_t)strlen(info.key);
+            uint32_t len32 = (uint32_t)vlen;
+            if (export_append(buf, &off, &type, 1) != ESP_OK ||
+                export_append(buf, &off, &keylen, 1) != ESP_OK ||
+                export_append(buf, &off, info.key, keylen) != ESP_OK ||
+                export_append(buf, &off, &len32, 4) != ESP_OK ||
+                export_append(buf, &off, val, vlen) != ESP_OK) {
+                ESP_LOGE(TAG, "Namespace too large for export buffer");
+                nvs_release_iterator(it);
+                goto out;
+            }
+            count++;
+        }
+        err = nvs_entry_next(&it);
+    }
+
+    memcpy(buf + 4, &count, 2);
+
+    size_t b64_len = 0;
+    mbedtls_base64_encode(NULL, 0, &b64_len, buf, off);
+    b64 = malloc(b64_len + 1);
+    if (b64 == NULL ||
+        mbedtls_base64_encode(b64, b64_len + 1, &b64_len, buf, off) != 0) {
+        goto out;
+    }
+
+    printf("---- BEGIN NVS EXPORT '%s' (%u keys, %u bytes) ----\n",
+        current_namespace, count, (unsigned)off);
+    for (size_t i = 0; i < b64_len; i += EXPORT_LINE_LEN) {
+        printf("%.*s\n", (int)(b64_len - i < EXPORT_LINE_LEN ? b64_len - i : EXPORT_LINE_LEN), b64 + i);
+    }
+    printf("---- END NVS EXPORT ----\n");
+    ret = 0;
+
+out:
+    free(b64);
+    free(val);
+    free(buf);
+    nvs_close(nvs);
+    return ret;
+}
+
+static int import_namespace(int argc, char **argv)
+{
+    char line[EXPORT_LINE_LEN + 4];
+    char *b64 = malloc(EXPORT_BUF_SIZE * 2);
+    uint8_t *buf = malloc(EXPORT_BUF_SIZE);
+    size_t b64_len = 0;
+    int ret = 1;
+
+    if (b64 == NULL || buf == NULL) {
+        free(b64);
+        free(buf);
+        return 1;
+    }
+
+    printf("Paste the export for namespace '%s'; empty line ends input.\n",
+        current_namespace);
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        bool had_data = false;
+        for (char *p = line; *p != '\0'; p++) {
+            if (*p == '\r' || *p == '\n' || *p == ' ') {
+                continue;
+            }
+            if (*p == '-') { /* BEGIN/END marker line */
+                had_data = true;
+                break;
+            }
+            if (b64_len < EXPORT_BUF_SIZE * 2 - 1) {
+                b64[b64_len++] = *p;
+            }
+            had_data = true;
+        }
+        if (!had_data) {
+            break;
+        }
+    }
+
+    size_t len = 0;
+    if (mbedtls_base64_decode(buf, EXPORT_BUF_SIZE, &len, (unsigned char *)b64, b64_len) != 0
+            || len < 6 || memcmp(buf, EXPORT_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "Invalid or truncated export data");
+        goto out;
+    }
+
+    uint16_t count;
+    memcpy(&count, buf + 4, 2);
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(current_namespace, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "%s", esp_err_to_name(err));
+        goto out;
+    }
+
+    size_t off = 6;
+    uint16_t stored = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (off + 2 > len) {
+            break;
+        }
+        uint8_t type = buf[off++];
+        uint8_t keylen = buf[off++];
+        char key[NVS_KEY_NAME_MAX_SIZE];
+        if (keylen >= sizeof(key) || off + keylen + 4 > len) {
+            break;
+        }
+        memcpy(key, buf + off, keylen);
+        key[keylen] = '\0';
+        off += keylen;
+        uint32_t vlen;
+        memcpy(&vlen, buf + off, 4);
+        off += 4;
+        if (off + vlen > len) {
+            break;
+        }
+        uint8_t *v = buf + off;
+        off += vlen;
+
+        err = ESP_OK;
+        switch ((nvs_type_t)type) {
+            case NVS_TYPE_I8:  err = nvs_set_i8(nvs, key, *(int8_t *)v); break;
+            case NVS_TYPE_U8:  err = nvs_set_u8(nvs, key, *v); break;
+            case NVS_TYPE_I16: { int16_t x; memcpy(&x, v, 2); err = nvs_set_i16(nvs, key, x); } break;
+            case NVS_TYPE_U16: { uint16_t x; memcpy(&x, v, 2); err = nvs_set_u16(nvs, key, x); } break;
+            case NVS_TYPE_I32: { int32_t x; memcpy(&x, v, 4); err = nvs_set_i32(nvs, key, x); } break;
+            case NVS_TYPE_U32: { uint32_t x; memcpy(&x, v, 4); err = nvs_set_u32(nvs, key, x); } break;
+            case NVS_TYPE_I64: { int64_t x; memcpy(&x, v, 8); err = nvs_set_i64(nvs, key, x); } break;
+            case NVS_TYPE_U64: { uint64_t x; memcpy(&x, v, 8); err = nvs_set_u64(nvs, key, x); } break;
+            case NVS_TYPE_STR: err = nvs_set_str(nvs, key, (char *)v); break;
+            case NVS_TYPE_BLOB: err = nvs_set_blob(nvs, key, v, vlen); break;
+            default: err = ESP_ERR_NOT_SUPPORTED; break;
+        }
+        if (err == ESP_OK) {
+            stored++;
+        } else {
+            ESP_LOGE(TAG, "Key '%s' not stored (%s)", key, esp_err_to_name(err));
+        }
+    }
+
+    err = nvs_commit(nvs);
+    nvs_close(nvs);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Imported %u of %u keys into '%s'", stored, count, current_namespace);
+        ret = 0;
+    }
+
+out:
+    free(b64);
+    free(buf);
+    return ret;
+}
+
 void register_nvs(void)
 {
     set_args.key = arg_str1(NULL, NULL, "<key>", "key of the value to be set");
@@ -578,6 +821,20 @@ void register_nvs(void)
         .argtable = &namespace_args
     };
 
+    const esp_console_cmd_t export_cmd = {
+        .command = "nvs_export",
+        .help = "Dump the current namespace as one base64 blob for cloning",
+        .hint = NULL,
+        .func = &export_namespace,
+    };
+
+    const esp_console_cmd_t import_cmd = {
+        .command = "nvs_import",
+        .help = "Import a namespace blob produced by nvs_export (paste after the prompt)",
+        .hint = NULL,
+        .func = &import_namespace,
+    };
+
     const esp_console_cmd_t list_entries_cmd = {
         .command = "nvs_list",
         .help = "List stored key-value pairs stored in NVS."
@@ -595,4 +852,6 @@ void register_nvs(void)
     ESP_ERROR_CHECK(esp_console_cmd_register(&namespace_cmd));
     ESP_ERROR_CHECK(esp_console_cmd_register(&list_entries_cmd));
     ESP_ERROR_CHECK(esp_console_cmd_register(&erase_namespace_cmd));
+    ESP_ERROR_CHECK(esp_console_cmd_register(&export_cmd));
+    ESP_ERROR_CHECK(esp_console_cmd_register(&import_cmd));
 }
@@ -24,6 +24,7 @@
 #include "nvs_flash.h"
 
 #include "freertos/event_groups.h"
+#include "freertos/task.h"
 #include "esp_wifi.h"
 #include "esp_eap_client.h"
 
@@ -78,6 +79,49 @@ struct portmap_table_entry {
 };
 struct portmap_table_entry portmap_tab[IP_PORTMAP_MAX];
 
+/* Portmap changes are persisted off the hot path: the mutators update
+ * the RAM table and lwIP immediately, then wake this low-priority task
+ * to do the NVS blob write. A flash write suspends the flash cache, so
+ * it must never ride along with a forwarding burst. */
+static TaskHandle_t portmap_store_handle = NULL;
+
+static void portmap_store_task(void *arg)
+{
+    esp_err_t err;
+    nvs_handle_t nvs;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        /* Debounce: a scripted batch of portmap commands becomes one
+         * flash write instead of one per command. */
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+        ulTaskNotifyTake(pdTRUE, 0);
+
+        err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Storing portmap table failed (%s)", esp_err_to_name(err));
+            continue;
+        }
+        err = nvs_set_blob(nvs, "portmap_tab", portmap_tab, sizeof(portmap_tab));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+            if (err == ESP_OK) {
+                ESP_LOGI(TAG, "New portmap table stored.");
+            }
+        }
+        nvs_close(nvs);
+    }
+}
+
+static void portmap_store_request(void)
+{
+    if (portmap_store_handle == NULL) {
+        xTaskCreate(portmap_store_task, "portmap_store", 3072, NULL,
+                tskIDLE_PRIORITY + 1, &portmap_store_handle);
+    }
+    xTaskNotifyGive(portmap_store_handle);
+}
+
 esp_netif_t* wifiAP;
 esp_netif_t* wifiSTA;
 
@@ -176,9 +220,6 @@ esp_err_t get_portmap_tab() {
 }
 
 esp_err_t add_portmap(u8_t proto, u16_t mport, u32_t daddr, u16_t dport) {
-    esp_err_t err;
-    nvs_handle_t nvs;
-
     for (int i = 0; i<IP_PORTMAP_MAX; i++) {
         if (!portmap_tab[i].valid) {
             portmap_tab[i].proto = proto;
@@ -187,18 +228,7 @@ esp_err_t add_portmap(u8_t proto, u16_t mport, u32_t daddr, u16_t dport) {
             portmap_tab[i].dport = dport;
             portmap_tab[i].valid = 1;
 
-            err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
-            if (err != ESP_OK) {
-                return err;
-            }
-            err = nvs_set_blob(nvs, "portmap_tab", portmap_tab, sizeof(portmap_tab));
-            if (err == ESP_OK) {
-                err = nvs_commit(nvs);
-                if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "New portmap table stored.");
-                }
-            }
-            nvs_close(nvs);
+            portmap_store_request();
 
             ip_portmap_add(proto, my_ip, mport, daddr, dport);
 
@@ -209,25 +239,11 @@ esp_err_t add_portmap(u8_t proto, u16_t mport, u32_t daddr, u16_t dport) {
 }
 
 esp_err_t del_portmap(u8_t proto, u16_t mport) {
-    esp_err_t err;
-    nvs_handle_t nvs;
-
     for (int i = 0; i<IP_PORTMAP_MAX; i++) {
         if (portmap_tab[i].valid && portmap_tab[i].mport == mport && portmap_tab[i].proto == proto) {
             portmap_tab[i].valid = 0;
 
-            err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
-            if (err != ESP_OK) {
-                return err;
-            }
-            err = nvs_set_blob(nvs, "portmap_tab", portmap_tab, sizeof(portmap_tab));
-            if (err == ESP_OK) {
-                err = nvs_commit(nvs);
-                if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "New portmap table stored.");
-                }
-            }
-            nvs_close(nvs);
+            portmap_store_request();
 
             ip_portmap_remove(proto, mport);
             return ESP_OK;
@@ -27,6 +27,8 @@
 #error "IP_NAPT must be defined"
 #endif
 #include "lwip/lwip_napt.h"
+#include "lwip/stats.h"
+#include "lwip/priv/tcp_priv.h"
 
 #include "router_globals.h"
 #include "cmd_router.h"
@@ -44,6 +46,8 @@ static void register_set_ap(void);
 static void register_set_ap_ip(void);
 static void register_show(void);
 static void register_portmap(void);
+static void register_napt(void);
+static void register_netbuf(void);
 
 void preprocess_string(char* str)
 {
@@ -148,6 +152,8 @@ void register_router(void)
     register_set_ap();
     register_set_ap_ip();
     register_portmap();
+    register_napt();
+    register_netbuf();
     register_show();
 }
 
@@ -202,6 +208,7 @@ int set_sta(int argc, char **argv)
         if (err == ESP_OK) {
             err = nvs_commit(nvs);
             if (err == ESP_OK) {
+                config_blob_invalidate();
                 ESP_LOGI(TAG, "STA settings %s/%s stored.", set_sta_arg.ssid->sval[0], set_sta_arg.password->sval[0]);
             }
         }
@@ -268,6 +275,7 @@ int set_sta_static(int argc, char **argv)
             if (err == ESP_OK) {
               err = nvs_commit(nvs);
                 if (err == ESP_OK) {
+                    config_blob_invalidate();
                     ESP_LOGI(TAG, "STA Static IP settings %s/%s/%s stored.", set_sta_static_arg.static_ip->sval[0], set_sta_static_arg.subnet_mask->sval[0], set_sta_static_arg.gateway_addr->sval[0]);
                 }
             }
@@ -325,6 +333,7 @@ esp_err_t set_mac(const char *key, const char *interface, int argc, char **argv)
     if (err == ESP_OK) {
         err = nvs_commit(nvs);
         if (err == ESP_OK) {
+            config_blob_invalidate();
             ESP_LOGI(TAG, "%s mac address %02X:%02X:%02X:%02X:%02X:%02X stored.", interface, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
         }
     }
@@ -406,6 +415,7 @@ int set_ap(int argc, char **argv)
         if (err == ESP_OK) {
             err = nvs_commit(nvs);
             if (err == ESP_OK) {
+                config_blob_invalidate();
                 ESP_LOGI(TAG, "AP settings %s/%s stored.", set_ap_args.ssid->sval[0], set_ap_args.password->sval[0]);
             }
         }
@@ -458,6 +468,7 @@ int set_ap_ip(int argc, char **argv)
 
     err = nvs_set_str(nvs, "ap_ip", set_ap_ip_arg.ap_ip_str->sval[0]);
     if (err == ESP_OK) {
+        config_blob_invalidate();
         ESP_LOGI(TAG, "AP IP address %s stored.", set_ap_ip_arg.ap_ip_str->sval[0]);
     }
     nvs_close(nvs);
@@ -552,6 +563,156 @@ static void register_portmap(void)
     ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
 }
 
+/** Arguments used by 'napt' function */
+static struct {
+    struct arg_lit *flush;
+    struct arg_end *end;
+} napt_args;
+
+/* 'napt' command. The translation table is private to esp-lwip, so
+ * occupancy cannot be read and limits cannot be changed at runtime;
+ * the flush goes through the public enable/disable API and is the
+ * recovery tool when a chatty client has filled the table. */
+static int napt(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &napt_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, napt_args.end, argv[0]);
+        return 1;
+    }
+
+    if (napt_args.flush->count > 0) {
+        esp_err_t err = napt_mon_flush();
+        if (err != ESP_OK) {
+            printf("Flush failed: %s\n", esp_err_to_name(err));
+            return err;
+        }
+        printf("NAPT table flushed; flows re-translate on their next packet.\n");
+    }
+
+    struct napt_mon_stats stats;
+    napt_mon_get(&stats);
+    printf("NAPT table size: %d translations (compile-time, IP_NAPT_MAX)\n",
+        stats.table_max);
+    printf("Idle timeouts: TCP %lus, UDP %lus (compile-time)\n",
+        (unsigned long)stats.tcp_timeout_s, (unsigned long)stats.udp_timeout_s);
+    printf("Flushes since boot: %lu\n", (unsigned long)stats.flushes);
+
+    return 0;
+}
+
+static void register_napt(void)
+{
+    napt_args.flush = arg_lit0("-f", "--flush", "drop every NAPT translation now");
+    napt_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "napt",
+        .help = "Show NAPT table limits or flush all translations",
+        .hint = NULL,
+        .func = &napt,
+        .argtable = &napt_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'netbuf' function */
+static struct {
+    struct arg_int *rx_buf;
+    struct arg_int *tx_buf;
+    struct arg_int *ba_win;
+    struct arg_end *end;
+} netbuf_args;
+
+/* 'netbuf' command — live buffer stats plus persisted per-site sizing.
+ * The wifi driver buffer counts are read back from NVS at wifi_init(),
+ * so changes take effect on the next restart. The lwIP TCP window and
+ * pbuf pool sizes are compile-time (sdkconfig), so they are reported
+ * here but not settable. */
+static int netbuf(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &netbuf_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, netbuf_args.end, argv[0]);
+        return 1;
+    }
+
+    if (netbuf_args.rx_buf->count > 0 || netbuf_args.tx_buf->count > 0
+            || netbuf_args.ba_win->count > 0) {
+        nvs_handle_t nvs;
+        esp_err_t err = nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (err == ESP_OK && netbuf_args.rx_buf->count > 0) {
+            err = nvs_set_i32(nvs, "wifi_rx_buf", netbuf_args.rx_buf->ival[0]);
+        }
+        if (err == ESP_OK && netbuf_args.tx_buf->count > 0) {
+            err = nvs_set_i32(nvs, "wifi_tx_buf", netbuf_args.tx_buf->ival[0]);
+        }
+        if (err == ESP_OK && netbuf_args.ba_win->count > 0) {
+            err = nvs_set_i32(nvs, "wifi_ba_win", netbuf_args.ba_win->ival[0]);
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+        if (err != ESP_OK) {
+            return err;
+        }
+        printf("Buffer sizes stored, effective after restart.\n");
+    }
+
+    printf("Internal heap: %u free, %u min free, largest block %u\n",
+        heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+        heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+        heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+#if LWIP_STATS
+    printf("IP:  xmit %u recv %u drop %u memerr %u\n",
+        lwip_stats.ip.xmit, lwip_stats.ip.recv, lwip_stats.ip.drop, lwip_stats.ip.memerr);
+    printf("TCP: xmit %u recv %u drop %u memerr %u (segment alloc failures)\n",
+        lwip_stats.tcp.xmit, lwip_stats.tcp.recv, lwip_stats.tcp.drop, lwip_stats.tcp.memerr);
+    printf("UDP: xmit %u recv %u drop %u memerr %u\n",
+        lwip_stats.udp.xmit, lwip_stats.udp.recv, lwip_stats.udp.drop, lwip_stats.udp.memerr);
+#else
+    printf("lwIP stats disabled (CONFIG_LWIP_STATS)\n");
+#endif
+    printf("TCP window %u, send buffer %u (compile-time)\n", TCP_WND, TCP_SND_BUF);
+
+    struct napt_mon_stats stats;
+    napt_mon_get(&stats);
+    printf("NAPT table size: %d translations (compile-time)\n", stats.table_max);
+
+    int val;
+    const char *keys[] = { "wifi_rx_buf", "wifi_tx_buf", "wifi_ba_win" };
+    const char *what[] = { "dynamic RX buffers", "dynamic TX buffers", "RX BA window" };
+    for (int i = 0; i < 3; i++) {
+        val = 0;
+        if (get_config_param_int((char *)keys[i], &val) == ESP_OK && val > 0) {
+            printf("Stored %s: %d\n", what[i], val);
+        }
+    }
+
+    return 0;
+}
+
+static void register_netbuf(void)
+{
+    netbuf_args.rx_buf = arg_int0("-r", "--rxbuf", "<n>", "wifi dynamic RX buffer count");
+    netbuf_args.tx_buf = arg_int0("-t", "--txbuf", "<n>", "wifi dynamic TX buffer count");
+    netbuf_args.ba_win = arg_int0("-b", "--bawin", "<n>", "wifi RX block-ack window");
+    netbuf_args.end = arg_end(3);
+
+    const esp_console_cmd_t cmd = {
+        .command = "netbuf",
+        .help = "Show network buffer occupancy or set per-site wifi buffer sizes",
+        .hint = NULL,
+        .func = &netbuf,
+        .argtable = &netbuf_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
 /* 'show' command */
 static int show(int argc, char **argv)
 {
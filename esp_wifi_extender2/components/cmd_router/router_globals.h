@@ -44,6 +44,34 @@ void print_portmap_tab();
 esp_err_t add_portmap(uint8_t proto, uint16_t mport, uint32_t daddr, uint16_t dport);
 esp_err_t del_portmap(uint8_t proto, uint16_t mport);
 
+/* NAPT pressure relief (napt_mon.c). esp-lwip keeps the translation
+ * table private, so per-entry occupancy and eviction are out of reach;
+ * what is exposed here is the compiled-in limits and a full-table
+ * flush through the public enable/disable API. */
+struct napt_mon_stats {
+    uint16_t table_max;     /* IP_NAPT_MAX, compile-time */
+    uint32_t tcp_timeout_s; /* compile-time TCP idle timeout */
+    uint32_t udp_timeout_s; /* compile-time UDP idle timeout */
+    uint32_t flushes;       /* manual flushes since boot */
+};
+
+/* Logs the compiled-in limits. Call after ip_napt_enable(). */
+void napt_mon_init(void);
+
+/* Drops every NAPT translation by toggling NAPT on the AP address,
+ * executed on the tcpip thread. Active flows re-translate on their
+ * next packet. */
+esp_err_t napt_mon_flush(void);
+
+void napt_mon_get(struct napt_mon_stats *out);
+
+/* Uplink roaming engine (roam.c). Call once the STA side is up. */
+void roam_init(void);
+
+/* Drops the packed fast-boot config blob; call after changing any
+ * per-key config param so the next boot rebuilds it. */
+void config_blob_invalidate(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,7 @@
 #include "esp_console.h"
 #include "esp_system.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
 #include "esp_flash.h"
 #include "esp_chip_info.h"
 #include "driver/rtc_io.h"
@@ -28,6 +29,10 @@
 #define WITH_TASKS_INFO 1
 #endif
 
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) && defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+#define WITH_PROFILER 1
+#endif
+
 static const char *TAG = "cmd_system";
 
 static void register_free(void);
@@ -39,6 +44,9 @@ static void register_light_sleep(void);
 #if WITH_TASKS_INFO
 static void register_tasks(void);
 #endif
+#if WITH_PROFILER
+static void register_profile(void);
+#endif
 
 void register_system(void)
 {
@@ -51,6 +59,9 @@ void register_system(void)
 #if WITH_TASKS_INFO
     register_tasks();
 #endif
+#if WITH_PROFILER
+    register_profile();
+#endif
 }
 
 /* 'version' command */
@@ -178,6 +189,122 @@ static void register_tasks(void)
 
 #endif // WITH_TASKS_INFO
 
+/** 'profile' command streams per-task CPU usage deltas as CSV.
+ *
+ * Unlike 'tasks' this is a continuous sampler: every interval it diffs
+ * the FreeRTOS runtime counters against the previous snapshot, so the
+ * percentages show what ran *during* the window instead of cumulative
+ * averages since boot. One printf per task per interval, no allocations
+ * in the sampling loop — cheap enough to leave on while forwarding. */
+#if WITH_PROFILER
+
+#define PROFILE_MAX_TASKS 24
+
+static struct {
+    struct arg_int *interval;
+    struct arg_lit *stop;
+    struct arg_end *end;
+} profile_args;
+
+static TaskHandle_t profile_handle = NULL;
+static uint32_t profile_interval_ms = 5000;
+
+static void profile_task(void *arg)
+{
+    static TaskStatus_t prev[PROFILE_MAX_TASKS], cur[PROFILE_MAX_TASKS];
+    uint32_t prev_total, cur_total;
+    UBaseType_t prev_n, cur_n;
+
+    printf("ms,task,cpu_pct,stack_hwm,heap_free,heap_min\n");
+    prev_n = uxTaskGetSystemState(prev, PROFILE_MAX_TASKS, &prev_total);
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(profile_interval_ms));
+
+        cur_n = uxTaskGetSystemState(cur, PROFILE_MAX_TASKS, &cur_total);
+        uint32_t total_delta = cur_total - prev_total;
+        if (total_delta == 0) {
+            total_delta = 1;
+        }
+        uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+        uint32_t heap_free = esp_get_free_heap_size();
+        uint32_t heap_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+
+        for (UBaseType_t i = 0; i < cur_n; i++) {
+            uint32_t run_delta = cur[i].ulRunTimeCounter;
+            for (UBaseType_t j = 0; j < prev_n; j++) {
+                if (prev[j].xHandle == cur[i].xHandle) {
+                    run_delta = cur[i].ulRunTimeCounter - prev[j].ulRunTimeCounter;
+                    break;
+                }
+            }
+            /* percentage of one core's worth of runtime, tenths */
+            uint32_t pct10 = (uint32_t)(((uint64_t)run_delta * 1000) / total_delta);
+            if (pct10 == 0) {
+                continue; /* keep the stream short: idle tasks are implied */
+            }
+            printf("%lu,%s,%lu.%lu,%lu,%lu,%lu\n", now, cur[i].pcTaskName,
+                   pct10 / 10, pct10 % 10,
+                   (uint32_t)cur[i].usStackHighWaterMark, heap_free, heap_min);
+        }
+
+        memcpy(prev, cur, cur_n * sizeof(TaskStatus_t));
+        prev_n = cur_n;
+        prev_total = cur_total;
+    }
+}
+
+static int profile(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &profile_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, profile_args.end, argv[0]);
+        return 1;
+    }
+    if (profile_args.stop->count) {
+        if (profile_handle != NULL) {
+            vTaskDelete(profile_handle);
+            profile_handle = NULL;
+            ESP_LOGI(TAG, "Profiler stopped");
+        }
+        return 0;
+    }
+    if (profile_args.interval->count) {
+        int ival = profile_args.interval->ival[0];
+        if (ival < 100) {
+            ESP_LOGE(TAG, "Interval must be at least 100 ms");
+            return 1;
+        }
+        profile_interval_ms = ival;
+    }
+    if (profile_handle == NULL) {
+        if (xTaskCreate(profile_task, "profile", 3072, NULL,
+                        tskIDLE_PRIORITY + 1, &profile_handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create profiler task");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void register_profile(void)
+{
+    profile_args.interval = arg_int0("i", "interval", "<ms>", "Sampling interval, ms (default 5000)");
+    profile_args.stop = arg_lit0(NULL, "stop", "Stop a running profiler");
+    profile_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "profile",
+        .help = "Stream per-task CPU%, stack high-water mark and heap watermarks as CSV",
+        .hint = NULL,
+        .func = &profile,
+        .argtable = &profile_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+#endif // WITH_PROFILER
+
 /** 'deep_sleep' command puts the chip into deep sleep mode */
 
 static struct {
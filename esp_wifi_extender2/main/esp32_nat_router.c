@@ -200,6 +200,10 @@ esp_err_t add_portmap(u8_t proto, u16_t mport, u32_t daddr, u16_t dport) {
             }
             nvs_close(nvs);
 
+            /* The fast-boot blob embeds the portmap table; drop it so
+             * the next boot rebuilds from the per-key values. */
+            config_blob_invalidate();
+
             ip_portmap_add(proto, my_ip, mport, daddr, dport);
 
             return ESP_OK;
@@ -229,6 +233,8 @@ esp_err_t del_portmap(u8_t proto, u16_t mport) {
             }
             nvs_close(nvs);
 
+            config_blob_invalidate();
+
             ip_portmap_remove(proto, mport);
             return ESP_OK;
         }
@@ -441,6 +447,23 @@ void wifi_init(const uint8_t* mac, const char* ssid, const char* ent_username, c
                                                         &instance_got_ip));
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+
+    /* Per-site buffer sizing ('netbuf' command). The wifi driver buffer
+     * counts are init-time parameters, so sites with heap to spare can
+     * trade it for throughput without a custom build. */
+    int buf_num = 0;
+    if (get_config_param_int("wifi_rx_buf", &buf_num) == ESP_OK && buf_num > 0) {
+        cfg.dynamic_rx_buf_num = buf_num;
+    }
+    buf_num = 0;
+    if (get_config_param_int("wifi_tx_buf", &buf_num) == ESP_OK && buf_num > 0) {
+        cfg.dynamic_tx_buf_num = buf_num;
+    }
+    buf_num = 0;
+    if (get_config_param_int("wifi_ba_win", &buf_num) == ESP_OK && buf_num > 0) {
+        cfg.rx_ba_win = buf_num;
+    }
+
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
     /* ESP WIFI CONFIG */
@@ -542,10 +565,141 @@ char* param_set_default(const char* def_val) {
     return retval;
 }
 
+/* Packed single-blob config. One NVS read and a few memcpys replace the
+ * dozen per-key lookups and string parses at boot, so forwarding comes
+ * up well under 100 ms after NVS init. The per-key string params stay
+ * the source of truth: every config command invalidates the blob, the
+ * next boot falls back to the string path and rebuilds it. */
+
+#define CFG_BLOB_KEY     "cfg_blob"
+#define CFG_BLOB_MAGIC   0x52544E43 /* "CNTR" */
+#define CFG_BLOB_VERSION 1
+
+struct config_blob {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t mac_set;
+    uint8_t ap_mac_set;
+    uint8_t mac[6];
+    uint8_t ap_mac[6];
+    char ssid[33];
+    char passwd[65];
+    char ent_username[65];
+    char ent_identity[65];
+    char static_ip[16];
+    char subnet_mask[16];
+    char gateway_addr[16];
+    char ap_ssid[33];
+    char ap_passwd[65];
+    char ap_ip[16];
+    struct portmap_table_entry portmap[IP_PORTMAP_MAX];
+} __attribute__((packed));
+
+/* Loads the whole config in one NVS read; false means absent, stale
+ * version or bad size, and the string path must run. */
+static bool config_blob_load(void)
+{
+    nvs_handle_t nvs;
+    struct config_blob blob;
+    size_t len = sizeof(blob);
+
+    if (nvs_open(PARAM_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    esp_err_t err = nvs_get_blob(nvs, CFG_BLOB_KEY, &blob, &len);
+    nvs_close(nvs);
+    if (err != ESP_OK || len != sizeof(blob)
+            || blob.magic != CFG_BLOB_MAGIC || blob.version != CFG_BLOB_VERSION) {
+        return false;
+    }
+
+    ssid = param_set_default(blob.ssid);
+    passwd = param_set_default(blob.passwd);
+    ent_username = param_set_default(blob.ent_username);
+    ent_identity = param_set_default(blob.ent_identity);
+    static_ip = param_set_default(blob.static_ip);
+    subnet_mask = param_set_default(blob.subnet_mask);
+    gateway_addr = param_set_default(blob.gateway_addr);
+    ap_ssid = param_set_default(blob.ap_ssid);
+    ap_passwd = param_set_default(blob.ap_passwd);
+    ap_ip = param_set_default(blob.ap_ip);
+    if (blob.mac_set) {
+        mac = malloc(6);
+        memcpy(mac, blob.mac, 6);
+    }
+    if (blob.ap_mac_set) {
+        ap_mac = malloc(6);
+        memcpy(ap_mac, blob.ap_mac, 6);
+    }
+    memcpy(portmap_tab, blob.portmap, sizeof(portmap_tab));
+
+    return true;
+}
+
+/* Serializes the loaded runtime config back into the blob. */
+static void config_blob_save(void)
+{
+    nvs_handle_t nvs;
+    struct config_blob blob;
+
+    memset(&blob, 0, sizeof(blob));
+    blob.magic = CFG_BLOB_MAGIC;
+    blob.version = CFG_BLOB_VERSION;
+    strlcpy(blob.ssid, ssid, sizeof(blob.ssid));
+    strlcpy(blob.passwd, passwd, sizeof(blob.passwd));
+    strlcpy(blob.ent_username, ent_username, sizeof(blob.ent_username));
+    strlcpy(blob.ent_identity, ent_identity, sizeof(blob.ent_identity));
+    strlcpy(blob.static_ip, static_ip, sizeof(blob.static_ip));
+    strlcpy(blob.subnet_mask, subnet_mask, sizeof(blob.subnet_mask));
+    strlcpy(blob.gateway_addr, gateway_addr, sizeof(blob.gateway_addr));
+    strlcpy(blob.ap_ssid, ap_ssid, sizeof(blob.ap_ssid));
+    strlcpy(blob.ap_passwd, ap_passwd, sizeof(blob.ap_passwd));
+    strlcpy(blob.ap_ip, ap_ip, sizeof(blob.ap_ip));
+    if (mac != NULL) {
+        blob.mac_set = 1;
+        memcpy(blob.mac, mac, 6);
+    }
+    if (ap_mac != NULL) {
+        blob.ap_mac_set = 1;
+        memcpy(blob.ap_mac, ap_mac, 6);
+    }
+    memcpy(blob.portmap, portmap_tab, sizeof(blob.portmap));
+
+    if (nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(nvs, CFG_BLOB_KEY, &blob, sizeof(blob)) == ESP_OK
+            && nvs_commit(nvs) == ESP_OK) {
+        ESP_LOGI(TAG, "Config blob rebuilt for fast boot.");
+    }
+    nvs_close(nvs);
+}
+
+void config_blob_invalidate(void)
+{
+    nvs_handle_t nvs;
+
+    if (nvs_open(PARAM_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(nvs, CFG_BLOB_KEY) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
 void app_main(void)
 {
     initialize_nvs();
 
+#if CONFIG_SPIRAM
+    /* WROVER builds (sdkconfig.wrover.defaults): the heap-backed
+     * network buffers land in PSRAM, internal RAM stays reserved for
+     * DMA descriptors and the wifi driver's static RX buffers. */
+    ESP_LOGI(TAG, "PSRAM: %u bytes available for network buffers",
+        heap_caps_get_total_size(MALLOC_CAP_SPIRAM));
+#endif
+
 #if CONFIG_STORE_HISTORY
     initialize_filesystem();
     ESP_LOGI(TAG, "Command history enabled");
@@ -553,6 +707,9 @@ void app_main(void)
     ESP_LOGI(TAG, "Command history disabled");
 #endif
 
+    if (config_blob_load()) {
+        ESP_LOGI(TAG, "Config loaded from blob");
+    } else {
     get_config_param_blob("mac", &mac, 6);
     get_config_param_str("ssid", &ssid);
     if (ssid == NULL) {
@@ -598,6 +755,10 @@ void app_main(void)
 
     get_portmap_tab();
 
+    /* Migration: rebuild the blob so the next boot takes the fast path. */
+    config_blob_save();
+    }
+
     // Setup WIFI
     wifi_init(mac, ssid, ent_username, ent_identity, passwd, static_ip, subnet_mask, gateway_addr, ap_mac, ap_ssid, ap_passwd, ap_ip);
 
@@ -607,6 +768,10 @@ void app_main(void)
     ip_napt_enable(my_ap_ip, 1);
     ESP_LOGI(TAG, "NAT is enabled");
 
+    napt_mon_init();
+
+    roam_init();
+
     char* lock = NULL;
     get_config_param_str("lock", &lock);
     if (lock == NULL) {
@@ -0,0 +1,72 @@
+/* NAPT pressure relief
+
+   When a chatty client fills the lwIP NAPT table, new flows stall until
+   old translations time out on their own, which looks like the whole
+   network freezing. esp-lwip keeps the translation table private to
+   ip4_napt.c (the entries and their last-use stamps are static), so
+   per-entry accounting or LRU eviction is not possible from the
+   application without patching the lwIP component. What the public API
+   does support is dropping every translation at once: disabling and
+   re-enabling NAPT on the AP address frees the table, and established
+   flows re-create their entries on the next packet. This module wraps
+   that as a flush operation, run on the tcpip thread so it never races
+   per-packet table updates, and reports the compiled-in limits so an
+   operator can see what they are up against.
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_system.h"
+
+#include "lwip/opt.h"
+#include "lwip/tcpip.h"
+#if !IP_NAPT
+#error "IP_NAPT must be defined"
+#endif
+#include "lwip/lwip_napt.h"
+
+#include "router_globals.h"
+
+static const char *TAG = "napt_mon";
+
+static uint32_t s_flushes = 0;
+
+/* Runs on the tcpip thread: the enable/disable pair frees the whole
+ * translation table through lwIP's own path, no private state touched. */
+static void napt_flush_cb(void *arg)
+{
+    ip_napt_enable(my_ap_ip, 0);
+    ip_napt_enable(my_ap_ip, 1);
+}
+
+esp_err_t napt_mon_flush(void)
+{
+    if (my_ap_ip == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (tcpip_callback(napt_flush_cb, NULL) != ERR_OK) {
+        return ESP_FAIL;
+    }
+    s_flushes++;
+    ESP_LOGW(TAG, "NAPT table flushed; active flows re-translate on their next packet.");
+    return ESP_OK;
+}
+
+void napt_mon_init(void)
+{
+    ESP_LOGI(TAG, "NAPT limits (compile-time): %d translations, TCP timeout %ds, UDP timeout %ds",
+             IP_NAPT_MAX, IP_NAPT_TIMEOUT_MS_TCP / 1000, IP_NAPT_TIMEOUT_MS_UDP / 1000);
+}
+
+void napt_mon_get(struct napt_mon_stats *out)
+{
+    out->table_max = IP_NAPT_MAX;
+    out->tcp_timeout_s = IP_NAPT_TIMEOUT_MS_TCP / 1000;
+    out->udp_timeout_s = IP_NAPT_TIMEOUT_MS_UDP / 1000;
+    out->flushes = s_flushes;
+}
@@ -0,0 +1,176 @@
+/* Uplink roaming engine
+
+   Left alone, the STA side stays glued to a degrading upstream AP until
+   the link dies, then pays for a full scan plus reconnect while every
+   client's NAPT flow times out. This module scans in the background
+   while the link still works, ranks candidate BSSes for the same SSID
+   by RSSI, and when a clearly better one appears does a directed
+   reassociation: the target BSSID and channel go straight into the STA
+   config, so the rejoin skips the scan entirely.
+
+   With a single radio a true make-before-break is not possible; what we
+   preserve is the state that matters. The NAPT translation table and
+   portmap_tab live in RAM and key on the STA address, which survives the
+   roam (same network, same DHCP lease or static IP), so established
+   client connections resume as soon as the new association is up —
+   typically a few hundred ms instead of multi-second scan-and-rejoin.
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "router_globals.h"
+
+static const char *TAG = "roam";
+
+#define ROAM_CHECK_INTERVAL_MS (60 * 1000)
+#define ROAM_RSSI_THRESHOLD    (-70) /* only look around below this */
+#define ROAM_MIN_IMPROVEMENT_DB  8   /* hysteresis against ping-pong */
+#define ROAM_COOLDOWN_MS       (120 * 1000)
+#define ROAM_MAX_CANDIDATES    10
+
+static int8_t s_cur_rssi = 0;
+static uint32_t s_last_roam_ms = 0;
+static bool s_scan_pending = false;
+
+static void roam_scan_done(void)
+{
+    uint16_t num = ROAM_MAX_CANDIDATES;
+    wifi_ap_record_t records[ROAM_MAX_CANDIDATES];
+    wifi_ap_record_t current;
+
+    s_scan_pending = false;
+    if (esp_wifi_scan_get_ap_records(&num, records) != ESP_OK) {
+        return;
+    }
+    if (esp_wifi_sta_get_ap_info(&current) != ESP_OK) {
+        return; /* association dropped while scanning */
+    }
+
+    wifi_ap_record_t *best = NULL;
+    for (int i = 0; i < num; i++) {
+        if (strcmp((char *)records[i].ssid, ssid) != 0) {
+            continue;
+        }
+        if (memcmp(records[i].bssid, current.bssid, 6) == 0) {
+            continue;
+        }
+        if (best == NULL || records[i].rssi > best->rssi) {
+            best = &records[i];
+        }
+    }
+
+    if (best == NULL || best->rssi < current.rssi + ROAM_MIN_IMPROVEMENT_DB) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "roaming %02x:%02x:%02x:%02x:%02x:%02x (%d dBm) -> "
+        "%02x:%02x:%02x:%02x:%02x:%02x (%d dBm) ch%d",
+        current.bssid[0], current.bssid[1], current.bssid[2],
+        current.bssid[3], current.bssid[4], current.bssid[5], current.rssi,
+        best->bssid[0], best->bssid[1], best->bssid[2],
+        best->bssid[3], best->bssid[4], best->bssid[5], best->rssi,
+        best->primary);
+
+    /* Directed reassociation: pin the target so the rejoin needs no
+     * scan. NAPT and portmap state is left untouched; the GOT_IP handler
+     * re-applies the forwards against the (unchanged) STA address. */
+    wifi_config_t wifi_config;
+    if (esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config) != ESP_OK) {
+        return;
+    }
+    memcpy(wifi_config.sta.bssid, best->bssid, 6);
+    wifi_config.sta.bssid_set = 1;
+    wifi_config.sta.channel = best->primary;
+    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+
+    s_last_roam_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    esp_wifi_disconnect();
+    esp_wifi_connect();
+}
+
+static void roam_event_handler(void* arg, esp_event_base_t event_base,
+                               int32_t event_id, void* event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE && s_scan_pending) {
+        roam_scan_done();
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        /* If the pinned BSS rejects us, drop the pin so the normal
+         * reconnect logic can fall back to any BSS of the SSID. */
+        wifi_config_t wifi_config;
+        if (esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config) == ESP_OK
+                && wifi_config.sta.bssid_set) {
+            uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            if (now - s_last_roam_ms > 10 * 1000) {
+                wifi_config.sta.bssid_set = 0;
+                wifi_config.sta.channel = 0;
+                esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+                ESP_LOGI(TAG, "unpinning BSSID after failed association");
+            }
+        }
+    }
+}
+
+static void roam_task(void *arg)
+{
+    while (true) {
+        vTaskDelay(ROAM_CHECK_INTERVAL_MS / portTICK_PERIOD_MS);
+
+        if (!ap_connect || s_scan_pending) {
+            continue;
+        }
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        if (now - s_last_roam_ms < ROAM_COOLDOWN_MS) {
+            continue;
+        }
+
+        wifi_ap_record_t current;
+        if (esp_wifi_sta_get_ap_info(&current) != ESP_OK) {
+            continue;
+        }
+        s_cur_rssi = current.rssi;
+        if (current.rssi >= ROAM_RSSI_THRESHOLD) {
+            continue; /* link is fine, don't burn airtime scanning */
+        }
+
+        /* Short per-channel dwell keeps the off-channel gaps small so
+         * forwarding barely notices; the driver buffers while away. */
+        wifi_scan_config_t scan = {
+            .ssid = (uint8_t *)ssid,
+            .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+            .scan_time.active = { .min = 20, .max = 40 },
+        };
+        s_scan_pending = true;
+        if (esp_wifi_scan_start(&scan, false) != ESP_OK) {
+            s_scan_pending = false;
+        }
+    }
+}
+
+void roam_init(void)
+{
+    if (strlen(ssid) == 0) {
+        return; /* AP-only box, nothing to roam */
+    }
+
+    esp_event_handler_instance_t instance;
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
+                                                        ESP_EVENT_ANY_ID,
+                                                        &roam_event_handler,
+                                                        NULL,
+                                                        &instance));
+    xTaskCreate(roam_task, "roam", 3072, NULL, tskIDLE_PRIORITY + 1, NULL);
+    ESP_LOGI(TAG, "background roaming started (threshold %d dBm, +%d dB to move)",
+             ROAM_RSSI_THRESHOLD, ROAM_MIN_IMPROVEMENT_DB);
+}
@@ -6,9 +6,12 @@
 Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver();
 
 
+void buildDegreeTickTable();
+
 void motorInit(){
     pwm.begin();
   pwm.setPWMFreq(FREQUENCY);
+  buildDegreeTickTable();
 //    //Control Motor A
 //  moveMotorDegrees(90, motorA);
 //  
@@ -19,6 +22,41 @@ void motorInit(){
 //  moveMotorDegrees(i, motorC);
 }
 
+
+// Degree→tick conversion table, filled once in motorInit() from the
+// pulse-width constants above. The old path did a map() plus a float
+// divide and multiply per joint per gait tick; this is one array load.
+// (Built at startup rather than constexpr: the arduino-esp32 core here
+// compiles at gnu++11, which rejects loops in constexpr constructors.)
+uint16_t deg_ticks[181];
+
+void buildDegreeTickTable()
+{
+  for (int d = 0; d <= 180; d++) {
+    long pulse_wide = MIN_PULSE_WIDTH + (long)(MAX_PULSE_WIDTH - MIN_PULSE_WIDTH) * d / 180;
+    deg_ticks[d] = (uint16_t)(pulse_wide * FREQUENCY * 4096L / 1000000L);
+  }
+}
+
+inline uint16_t degreesToTicks(int degrees)
+{
+  if (degrees < 0) degrees = 0;
+  if (degrees > 180) degrees = 180;
+  return deg_ticks[degrees];
+}
+
+// Fixed-point variant: degrees in 8.8 format (e.g. 90.5° = 90*256+128),
+// linearly interpolated between table entries for sub-degree steps.
+inline uint16_t degreesToTicksFP(uint16_t degrees_fp8)
+{
+  int d = degrees_fp8 >> 8;
+  if (d >= 180) return deg_ticks[180];
+  uint16_t frac = degrees_fp8 & 0xFF;
+  uint16_t a = deg_ticks[d];
+  uint16_t b = deg_ticks[d + 1];
+  return a + (uint16_t)(((uint32_t)(b - a) * frac) >> 8);
+}
+
 void moveMotor(int controlIn, int motorOut)
 {
   int pulse_wide, pulse_width, potVal;
@@ -39,13 +77,41 @@ void moveMotor(int controlIn, int motorOut)
 
 void moveMotorDegrees (int controlIn, int motorOut)
 {
-  int pulse_wide, pulse_width;
-   
-  // Convert to pulse width
-  pulse_wide = map(controlIn, 0, 180, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
-  pulse_width = int(float(pulse_wide) / 1000000 * FREQUENCY * 4096);
-  
   //Control Motor
-  pwm.setPWM(motorOut, 0, pulse_width);
+  pwm.setPWM(motorOut, 0, degreesToTicks(controlIn));
+}
+
 
+// One full-body pose = 12 separate setPWM calls = 12 I2C transactions,
+// each with its own start/stop and register addressing. The PCA9685
+// auto-increments its register pointer within one transaction, so all
+// servo channels can be latched with a single burst write instead.
+#define PCA9685_I2C_ADDR      0x40
+#define PCA9685_LED0_ON_L     0x06
+#define SERVO_CHANNELS        12
+
+int servo_target[SERVO_CHANNELS];
+
+// Stage a target angle; nothing goes on the wire until setAllServos().
+void setServoTarget(int degrees, int motorOut)
+{
+  if (motorOut >= 0 && motorOut < SERVO_CHANNELS) {
+    servo_target[motorOut] = degrees;
+  }
+}
+
+// Write every channel's ON/OFF registers in one auto-increment I2C
+// burst (1 + 12*4 bytes), so all servos latch the new pose together.
+void setAllServos()
+{
+  Wire.beginTransmission(PCA9685_I2C_ADDR);
+  Wire.write(PCA9685_LED0_ON_L);
+  for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+    uint16_t pulse_width = degreesToTicks(servo_target[ch]);
+    Wire.write(0x00);                      // ON_L: pulse starts at tick 0
+    Wire.write(0x00);                      // ON_H
+    Wire.write(pulse_width & 0xFF);        // OFF_L
+    Wire.write((pulse_width >> 8) & 0x0F); // OFF_H
+  }
+  Wire.endTransmission();
 }